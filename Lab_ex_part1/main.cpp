@@ -11,6 +11,7 @@
 
 #include "cpxmacro.h"
 #include "Timer.h"
+#include "../Lab_ex_part2/Random.h"
 
 
 
@@ -190,24 +191,6 @@ int readPos(const char* filename, std::vector<std::vector<double>>& pos, std::ve
 	return n;
 }
 
-// better seed for srand() using a mix function
-unsigned long superSeed()
-{	
-	unsigned long a = clock();
-	unsigned long b = std::time(NULL);
-	unsigned long c = getpid();
-	a=a-b;  a=a-c;  a=a^(c >> 13);
-	b=b-c;  b=b-a;  b=b^(a << 8);
-	c=c-a;  c=c-b;  c=c^(b >> 13);
-	a=a-b;  a=a-c;  a=a^(c >> 12);
-	b=b-c;  b=b-a;  b=b^(a << 16);
-	c=c-a;  c=c-b;  c=c^(b >> 5);
-	a=a-b;  a=a-c;  a=a^(c >> 3);
-	b=b-c;  b=b-a;  b=b^(a << 10);
-	c=c-a;  c=c-b;  c=c^(b >> 15);
-	return c;
-}
-
 // random cost matrix
 void randomCost(const int n, std::vector<std::vector<double>>& pos, std::vector<std::vector<double>>& cost, const int classe)
 {
@@ -249,8 +232,8 @@ void randomCost(const int n, std::vector<std::vector<double>>& pos, std::vector<
 		std::cout << "All pairs done\n";
 	#endif
 
-    std::srand(superSeed());
-	std::random_shuffle(allPos.begin(),allPos.end()); // shuffle all pairs
+	Rng rng(Rng::INSTANCE);
+	rng.sample(allPos.begin(), allPos.end(), n); // n pairs drawn at random (same instance as Lab_ex_part2 for the same seed)
 
 	pos.resize(n);
 	for (int i = 0; i < n; i++) {
@@ -320,7 +303,7 @@ int main (int argc, char const *argv[])
 	try
 	{
 
-		if (argc < 3) throw std::runtime_error("usage: ./main filename.dat savedistsfile.dat [readDists] [Nrandom] [class]");
+		if (argc < 3) throw std::runtime_error("usage: ./main filename.dat savedistsfile.dat [readDists] [Nrandom] [class] [seed]");
 
 		std::vector<std::vector<double>> cost;
 		std::vector<std::vector<double>> pos;
@@ -329,7 +312,8 @@ int main (int argc, char const *argv[])
 
 		if (argc >= 5) {
 			N = atoi(argv[4]);
-			if (argc == 6 && N > 3) classe = atoi(argv[5]); // class 2 only possible for 4x4 maps or larger
+			if (argc >= 6 && N > 3) classe = atoi(argv[5]); // class 2 only possible for 4x4 maps or larger
+			if (argc == 7) Rng::setRunSeed(std::strtoull(argv[6], NULL, 10)); // reproducible instance
 			randomCost(N,pos,cost,classe);
 			saveDists(argv[2], cost, N);
 		}
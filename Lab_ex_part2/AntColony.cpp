@@ -0,0 +1,221 @@
+/**
+ * @file AntColony.cpp
+ * @brief TSP ant colony solver (MAX-MIN ant system)
+ *
+ */
+
+#include "AntColony.h"
+#include <thread>
+#include <cmath>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+bool AntColonySolver::solve ( const TSP& tsp , const TSPSolution& initSol , int maxIter , TSPSolution& bestSol )
+{
+    try
+    {
+        n = tsp.n;
+        bestSol = initSol;
+        if ( n < 4 ) return true; // a single tour
+
+        int nAnts    = ( ants > 0 ) ? ants : std::min(n, 100);
+        int nThreads = std::max(1, std::min(threads, nAnts));
+        double bestValue = solver.evaluate(bestSol, tsp);
+        cand.build(tsp, candidates, candidateRule, bestValue);
+        float  tauMax = 1.0 / (rho * bestValue);
+        float  tauMin = tauMax / (2.0 * n);
+
+        tau.assign(n*n, tauMax);
+        deposit.assign(n*n, 0.0f);
+        weight.resize(n*n);
+        eta.resize(n*n);
+        for ( int i = 0 ; i < n ; ++i ) {
+            for ( int j = 0 ; j < n ; ++j ) {
+                eta[i*n+j] = std::pow(1.0 / std::max(tsp.cost[i][j], 1e-6), beta);
+            }
+        }
+        computeWeights();
+
+        std::vector<Worker> workers;
+        workers.reserve(nThreads);
+        for ( int t = 0 ; t < nThreads ; ++t ) {
+            workers.emplace_back(tsp);
+            workers[t].rng = Rng(Rng::THREADS + t); // stream of the thread
+            workers[t].visited.resize(n);
+            workers[t].tour.resize(n);
+            workers[t].prob.resize(cand.k);
+            workers[t].batch.reset(n, (nAnts - t + nThreads - 1) / nThreads);
+            workers[t].value.resize(workers[t].batch.capacity);
+        }
+        BatchEvaluator evaluator(tsp);
+
+        TSPSolution iterBest(tsp);
+        int lastImprovement = 0;
+
+        for ( int iter = 1 ; iter <= maxIter ; ++iter )
+        {
+            // build the tours (the weights are read-only here)
+            auto run = [&] (int t) {
+                Worker& w = workers[t];
+                w.bestValue = tsp.infinite;
+                w.batch.clear();
+                for ( int a = t ; a < nAnts ; a += nThreads ) {
+                    buildTour(w);
+                    w.batch.store(w.batch.size, w.ant);
+                }
+                evaluator.evaluate(w.batch, w.value.data());
+                int bestAnt = 0;
+                for ( int a = 0 ; a < w.batch.size ; ++a ) {
+                    if ( w.value[a] < w.bestValue ) { w.bestValue = w.value[a]; bestAnt = a; }
+                }
+                w.batch.load(bestAnt, w.best);
+            };
+            if ( nThreads == 1 ) run(0);
+            else {
+                std::vector<std::thread> pool;
+                for ( int t = 0 ; t < nThreads ; ++t ) pool.emplace_back(run, t);
+                for ( auto& th : pool ) th.join();
+            }
+
+            int bw = 0;
+            for ( int t = 1 ; t < nThreads ; ++t ) {
+                if ( workers[t].bestValue < workers[bw].bestValue ) bw = t;
+            }
+            iterBest = workers[bw].best;
+            double iterValue = ls.twoOpt(tsp, iterBest, workers[bw].bestValue);
+
+            if ( iterValue < bestValue - 0.01 ) {
+                bestValue = iterValue;
+                bestSol = iterBest;
+                lastImprovement = iter;
+                tauMax = 1.0 / (rho * bestValue);
+                tauMin = tauMax / (2.0 * n);
+            }
+
+            #if PRINT_ALL_TPSOLVER
+                std::cout << "(" << iter << "it) iteration best " << iterValue << "\tbest " << bestValue << std::endl;
+            #endif
+
+            if ( iter - lastImprovement > 50 ) { // stagnation: pheromone trail reinitialization
+                std::fill(tau.begin(), tau.end(), tauMax);
+                computeWeights();
+                lastImprovement = iter;
+                continue;
+            }
+
+            // MAX-MIN: only the iteration best (every 10 iterations the best so far) lays pheromone
+            if ( iter % 10 == 0 ) layPheromone(bestSol, bestValue);
+            else                  layPheromone(iterBest, iterValue);
+            updatePheromone(tauMin, tauMax);
+        }
+    }
+    catch(std::exception& e){
+        std::cout << ">>>EXCEPTION: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void AntColonySolver::buildTour ( Worker& w )
+{
+    std::fill(w.visited.begin(), w.visited.end(), 0);
+
+    int cur = w.rng.below(n);
+    w.tour[0] = cur;
+    w.visited[cur] = 1;
+
+    for ( int step = 1 ; step < n ; ++step ) {
+        const int*   c   = cand.neighbors(cur);
+        const float* row = &weight[cur*n];
+
+        // roulette wheel on the free candidates
+        float sum = 0.0f;
+        for ( int q = 0 ; q < cand.k ; ++q ) {
+            w.prob[q] = w.visited[c[q]] ? 0.0f : row[c[q]];
+            sum += w.prob[q];
+        }
+        int next = -1;
+        if ( sum > 0.0f ) {
+            float r = (float)w.rng.uniform() * sum;
+            for ( int q = 0 ; q < cand.k ; ++q ) {
+                r -= w.prob[q];
+                if ( w.prob[q] > 0.0f ) next = c[q];
+                if ( r <= 0.0f && next >= 0 ) break;
+            }
+        }
+        else { // all the candidates already visited: best weight among the other nodes
+            float best = -1.0f;
+            for ( int j = 0 ; j < n ; ++j ) {
+                if ( !w.visited[j] && row[j] > best ) { best = row[j]; next = j; }
+            }
+        }
+
+        w.tour[step] = next;
+        w.visited[next] = 1;
+        cur = next;
+    }
+
+    // back to a sequence from node 0
+    int start = std::find(w.tour.begin(), w.tour.end(), 0) - w.tour.begin();
+    for ( int t = 0 ; t < n ; ++t ) w.ant.sequence[t] = w.tour[(start + t) % n];
+    w.ant.sequence[n] = 0;
+}
+
+void AntColonySolver::layPheromone ( const TSPSolution& sol , double value )
+{
+    float amount = 1.0 / value;
+    for ( int k = 0 ; k < n ; ++k ) {
+        int i = sol.sequence[k];
+        int j = sol.sequence[k+1];
+        deposit[i*n+j] += amount;
+        deposit[j*n+i] += amount;
+    }
+}
+
+void AntColonySolver::updatePheromone ( float tauMin , float tauMax )
+{
+    // single pass on the flat matrices: tau = clamp((1-rho)*tau + deposit), deposit = 0
+    // and (alpha = 1) weight = tau * eta^beta
+    const float keep = 1.0f - rho;
+    const bool  linear = ( alpha == 1.0 );
+    float* t = tau.data();
+    float* d = deposit.data();
+    float* w = weight.data();
+    const float* e = eta.data();
+    size_t size = tau.size();
+    size_t k = 0;
+
+#ifdef __SSE2__
+    const __m128 vKeep = _mm_set1_ps(keep);
+    const __m128 vMin  = _mm_set1_ps(tauMin);
+    const __m128 vMax  = _mm_set1_ps(tauMax);
+    const __m128 zero  = _mm_setzero_ps();
+    for ( ; k + 4 <= size ; k += 4 ) {
+        __m128 v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(t + k), vKeep), _mm_loadu_ps(d + k));
+        v = _mm_min_ps(_mm_max_ps(v, vMin), vMax);
+        _mm_storeu_ps(t + k, v);
+        _mm_storeu_ps(d + k, zero);
+        if ( linear ) _mm_storeu_ps(w + k, _mm_mul_ps(v, _mm_loadu_ps(e + k)));
+    }
+#endif
+    for ( ; k < size ; ++k ) {
+        t[k] = std::min(std::max(t[k] * keep + d[k], tauMin), tauMax);
+        d[k] = 0.0f;
+        if ( linear ) w[k] = t[k] * e[k];
+    }
+
+    if ( !linear ) computeWeights();
+}
+
+void AntColonySolver::computeWeights ( )
+{
+    const float a = alpha;
+    size_t size = tau.size();
+    if ( alpha == 1.0 ) {
+        for ( size_t k = 0 ; k < size ; ++k ) weight[k] = tau[k] * eta[k];
+    }
+    else {
+        for ( size_t k = 0 ; k < size ; ++k ) weight[k] = std::pow(tau[k], a) * eta[k];
+    }
+}
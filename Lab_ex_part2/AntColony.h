@@ -0,0 +1,76 @@
+/**
+ * @file AntColony.h
+ * @brief TSP ant colony solver (MAX-MIN ant system)
+ *
+ */
+
+#pragma once
+
+#include "TSPSolver.h"
+#include "LocalSearch.h"
+#include "CandidateList.h"
+#include "BatchEvaluator.h"
+
+/**
+ * Class that solves a TSP problem with a MAX-MIN ant system: ants build tours on the candidate
+ * lists, choosing the next node with probability proportional to tau^alpha * eta^beta.
+ * The weights are computed once per iteration (flat float matrices) and shared by all the ants,
+ * that are split among 'threads' threads
+ */
+class AntColonySolver
+{
+public:
+
+    AntColonySolver ( int ants = 0 , int threads = 1 , int candidates = 15 , double alpha = 1.0 , double beta = 2.0 , double rho = 0.1 )
+        : candidateRule(CandidateList::NEAREST) ,
+          ants(ants) , threads(threads) , candidates(candidates) , alpha(alpha) , beta(beta) , rho(rho) { }
+
+    CandidateList::Rule candidateRule; // neighbours by cost or by alpha-nearness
+
+    /** solve
+     * @param tsp TSP instance
+     * @param initSol initial solution (first incumbent, sets the initial pheromone)
+     * @param maxIter number of iterations (colony generations)
+     * @param bestSol best solution found
+     * @return true if no exception
+     */
+    bool solve ( const TSP& tsp , const TSPSolution& initSol , int maxIter , TSPSolution& bestSol );
+
+protected:
+    int    ants;        // ants per iteration (0: one per node, at most 100)
+    int    threads;
+    int    candidates;  // candidate list length
+    double alpha;       // pheromone exponent
+    double beta;        // heuristic exponent
+    double rho;         // evaporation rate
+
+    TSPSolver     solver; // evaluate()
+    LocalSearch   ls;
+    CandidateList cand;
+
+    int n;
+    std::vector<float> tau;     // pheromone, tau[i*n+j]
+    std::vector<float> eta;     // eta^beta = (1/cost)^beta, fixed
+    std::vector<float> weight;  // tau^alpha * eta^beta, refreshed every iteration
+    std::vector<float> deposit; // pheromone laid by this iteration's ants, cleared by updatePheromone()
+
+    /// per thread ant buffers (best ant of the thread in 'best')
+    struct Worker {
+        Rng                rng;
+        std::vector<char>  visited;
+        std::vector<int>   tour;
+        std::vector<float> prob;
+        TSPSolution        ant;
+        TSPSolution        best;
+        double             bestValue;
+        TourBatch          batch;  // the ants of the thread, evaluated together
+        std::vector<double> value;
+
+        Worker ( const TSP& tsp ) : ant(tsp) , best(tsp) , bestValue(0) { }
+    };
+
+    void buildTour ( Worker& w );
+    void layPheromone ( const TSPSolution& sol , double value );
+    void updatePheromone ( float tauMin , float tauMax );
+    void computeWeights ( );
+};
@@ -0,0 +1,131 @@
+/**
+ * @file BatchEvaluator.h
+ * @brief length of many tours at once (structure of arrays block of tours)
+ *
+ */
+
+#pragma once
+
+#include <vector>
+#include "TSPSolution.h"
+
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+/**
+ * Block of tours stored position by position: node(k, t) = node[k*capacity + t] is the node at position k of tour t,
+ * so the tours of a block are read together, one position at a time
+ */
+class TourBatch
+{
+public:
+    TourBatch ( ) : n(0) , capacity(0) , size(0) { }
+
+    /** empty block of 'capacity' tours on n nodes
+     * @return ---
+     */
+    void reset ( int nodes , int cap ) {
+        n = nodes;
+        capacity = cap;
+        size = 0;
+        node.resize((size_t)(n + 1) * capacity);
+    }
+
+    void clear ( ) { size = 0; }
+    bool full ( ) const { return size == capacity; }
+
+    /// copy a tour in slot t (t == size appends it)
+    void store ( int t , const TSPSolution& sol ) {
+        for ( int k = 0 ; k <= n ; ++k ) node[(size_t)k * capacity + t] = sol.sequence[k];
+        if ( t >= size ) size = t + 1;
+    }
+
+    void load ( int t , TSPSolution& sol ) const {
+        for ( int k = 0 ; k <= n ; ++k ) sol.sequence[k] = node[(size_t)k * capacity + t];
+    }
+
+    int n;
+    int capacity;
+    int size;
+    std::vector<int> node;
+};
+
+/**
+ * Class that computes tour lengths. A block of tours is scanned BLOCK tours at a time with one accumulator per tour.
+ * With AVX2 (checked at run time, the build stays plain x86-64) a position of 4 tours costs two gathers: the 4 cost
+ * rows from the row table, then the 4 costs at their addresses; otherwise the BLOCK scalar loads are independent,
+ * so they are in flight together. Each length is summed in the order of the positions (one lane per tour), so it
+ * is the same value as TSPSolver::evaluate
+ */
+class BatchEvaluator
+{
+public:
+    static constexpr int BLOCK = 8;
+
+    BatchEvaluator ( const TSP& tsp ) : n(tsp.n) , rows(tsp.n) {
+        for ( int i = 0 ; i < n ; ++i ) rows[i] = tsp.cost[i].data();
+    }
+
+    /** lengths of the tours of a block
+     * @param batch tours
+     * @param value value[t] = length of tour t (batch.size values)
+     * @return ---
+     */
+    void evaluate ( const TourBatch& batch , double* value ) const
+    {
+        const int cap = batch.capacity;
+        for ( int t0 = 0 ; t0 < batch.size ; t0 += BLOCK ) {
+            int m = std::min(BLOCK, batch.size - t0);
+            double total[BLOCK] = { };
+            const int* prev = &batch.node[t0];
+#ifdef __x86_64__
+            if ( m == BLOCK && avx2() ) gatherBlock(prev, cap, total);
+            else
+#endif
+            if ( m == BLOCK ) { // full block: fixed trip count, unrolled by the compiler
+                for ( int k = 0 ; k < n ; ++k ) {
+                    const int* next = prev + cap;
+                    #pragma GCC unroll 8
+                    for ( int t = 0 ; t < BLOCK ; ++t ) total[t] += rows[prev[t]][next[t]];
+                    prev = next;
+                }
+            }
+            else {
+                for ( int k = 0 ; k < n ; ++k ) {
+                    const int* next = prev + cap;
+                    for ( int t = 0 ; t < m ; ++t ) total[t] += rows[prev[t]][next[t]];
+                    prev = next;
+                }
+            }
+            for ( int t = 0 ; t < m ; ++t ) value[t0 + t] = total[t];
+        }
+    }
+
+private:
+    int n;
+    std::vector<const double*> rows; // cost rows (no copy of the matrix)
+
+#ifdef __x86_64__
+    static bool avx2 ( ) { static const bool has = __builtin_cpu_supports("avx2"); return has; }
+
+    /// lengths of the BLOCK tours starting at prev (a full block): 4 tours per vector
+    __attribute__((target("avx2")))
+    void gatherBlock ( const int* prev , int cap , double* total ) const
+    {
+        const long long* table = (const long long*)rows.data();
+        __m256d sum[BLOCK / 4];
+        for ( int h = 0 ; h < BLOCK / 4 ; ++h ) sum[h] = _mm256_setzero_pd();
+        for ( int k = 0 ; k < n ; ++k ) {
+            const int* next = prev + cap;
+            for ( int h = 0 ; h < BLOCK / 4 ; ++h ) {
+                __m256i row = _mm256_i32gather_epi64(table, _mm_loadu_si128((const __m128i*)(prev + 4*h)), 8);
+                __m256i col = _mm256_slli_epi64(_mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(next + 4*h))), 3);
+                sum[h] = _mm256_add_pd(sum[h], _mm256_i64gather_pd((const double*)0, _mm256_add_epi64(row, col), 1));
+            }
+            prev = next;
+        }
+        for ( int h = 0 ; h < BLOCK / 4 ; ++h ) _mm256_storeu_pd(total + 4*h, sum[h]);
+    }
+#endif
+};
@@ -0,0 +1,221 @@
+/**
+ * @file BranchBound.cpp
+ * @brief TSP exact solver by branch and bound on 1-tree bounds (parallel, work stealing)
+ *
+ */
+
+#include "BranchBound.h"
+#include "HeldKarp.h"
+#include <thread>
+
+double BranchBoundSolver::solve ( const TSP& tsp , const TSPSolution& initSol , TSPSolution& bestSol )
+{
+    n = tsp.n;
+    bestSol = initSol;
+    double initValue = 0.0;
+    for ( int k = 0 ; k < n ; ++k ) initValue += tsp.cost[initSol.sequence[k]][initSol.sequence[k+1]];
+    upper = initValue;
+    nodeCount = 0;
+    root = initValue;
+    if ( n < 5 ) return root = HeldKarpSolver().solve(tsp, bestSol); // too small for 1-trees and branching
+
+    integral = true;
+    for ( int i = 0 ; i < n ; ++i ) {
+        for ( int j = 0 ; j < n ; ++j ) if ( tsp.cost[i][j] != std::floor(tsp.cost[i][j]) ) integral = false;
+    }
+
+    int nThreads = std::max(1, threads);
+    work.assign(nThreads, std::deque<Node>());
+    std::vector<std::mutex> locks(nThreads);
+    workLock.swap(locks);
+
+    Node first;
+    first.state.assign(n*n, 0);
+    for ( int v = 0 ; v < n ; ++v ) first.state[v*n+v] = -1;
+    first.pi.assign(n, 0.0);
+    first.bound = -tsp.infinite;
+    first.depth = 0;
+    pending = 1;
+    work[0].push_back(std::move(first));
+
+    auto run = [&] (int t) {
+        OneTree tree(tsp);
+        Node node;
+        while ( pending.load() > 0 ) {
+            if ( !take(t, node) ) { std::this_thread::yield(); continue; }
+            explore(tsp, tree, node, t, bestSol);
+            nodeCount++;
+            pending--;
+        }
+    };
+    if ( nThreads == 1 ) run(0);
+    else {
+        std::vector<std::thread> pool;
+        for ( int t = 0 ; t < nThreads ; ++t ) pool.emplace_back(run, t);
+        for ( auto& th : pool ) th.join();
+    }
+
+    #if PRINT_ALL_TPSOLVER
+        std::cout << "B&B: " << nodeCount << " nodes, root bound " << root << std::endl;
+    #endif
+
+    return upper.load();
+}
+
+void BranchBoundSolver::explore ( const TSP& tsp , OneTree& tree , Node& node , int t , TSPSolution& bestSol )
+{
+    if ( pruned(node.bound) ) return;
+
+    int iterations = ( node.depth == 0 ) ? rootIterations : nodeIterations;
+    double lambda = ( node.depth == 0 ) ? 2.0 : 0.5;
+    double bound = tree.ascent(node.pi, upper.load(), iterations, lambda, &node.state);
+    if ( bound >= tsp.infinite ) return; // no tour respects the fixed edges
+    if ( node.depth == 0 ) root = bound;
+
+    if ( tree.isTour() ) { // optimal for this subtree
+        std::vector<int> adj(2*n);
+        std::vector<int> filled(n, 0);
+        auto link = [&](int u, int v) { adj[2*u + filled[u]++] = v; adj[2*v + filled[v]++] = u; };
+        for ( int v = 2 ; v < n ; ++v ) link(v, tree.parent[v]);
+        link(0, tree.zeroA);
+        link(0, tree.zeroB);
+        TSPSolution tour(tsp);
+        tour.fromAdjacency(adj);
+        double value = 0.0;
+        for ( int k = 0 ; k < n ; ++k ) value += tsp.cost[tour.sequence[k]][tour.sequence[k+1]];
+
+        std::lock_guard<std::mutex> lock(incumbentLock);
+        if ( value < upper.load() - 1e-9 ) {
+            upper = value;
+            bestSol = tour;
+        }
+        return;
+    }
+    if ( pruned(bound) ) return;
+
+    // branching node: largest degree (lowest index on ties)
+    int v = 0;
+    for ( int u = 1 ; u < n ; ++u ) if ( tree.degree[u] > tree.degree[v] ) v = u;
+
+    // its free tree edge with the largest penalised cost
+    int best = -1;
+    double bestCost = 0;
+    auto consider = [&](int w) {
+        if ( node.state[v*n+w] != 0 ) return;
+        double c = tsp.cost[v][w] + node.pi[v] + node.pi[w];
+        if ( best < 0 || c > bestCost ) { best = w; bestCost = c; }
+    };
+    if ( v >= 2 ) consider(tree.parent[v]);
+    for ( int w = 2 ; w < n ; ++w ) if ( tree.parent[w] == v ) consider(w);
+    if ( v == tree.zeroA || v == tree.zeroB ) consider(0);
+    if ( best < 0 ) return; // cannot happen: at most two fixed edges per node
+
+    Node in;
+    in.state = node.state;
+    in.pi = node.pi;
+    in.bound = bound;
+    in.depth = node.depth + 1;
+    Node out = in;
+    bool inOk = fix(in.state, v, best, 1);
+    bool outOk = fix(out.state, v, best, -1);
+    if ( inOk ) push(t, std::move(in));
+    if ( outOk ) push(t, std::move(out)); // explored first
+}
+
+void BranchBoundSolver::push ( int t , Node&& node )
+{
+    pending++;
+    std::lock_guard<std::mutex> lock(workLock[t]);
+    work[t].push_back(std::move(node));
+}
+
+bool BranchBoundSolver::take ( int t , Node& node )
+{
+    int T = work.size();
+    for ( int k = 0 ; k < T ; ++k ) {
+        int q = (t + k) % T;
+        std::lock_guard<std::mutex> lock(workLock[q]);
+        if ( work[q].empty() ) continue;
+        if ( q == t ) { node = std::move(work[q].back());  work[q].pop_back(); }  // own work: depth first
+        else          { node = std::move(work[q].front()); work[q].pop_front(); } // stolen: the oldest node
+        return true;
+    }
+    return false;
+}
+
+bool BranchBoundSolver::fix ( std::vector<signed char>& state , int u , int v , signed char s ) const
+{
+    state[u*n+v] = state[v*n+u] = s;
+    return propagate(state);
+}
+
+bool BranchBoundSolver::propagate ( std::vector<signed char>& state ) const
+{
+    std::vector<int>  degree(n);
+    std::vector<char> visited(n);
+    auto nextOnPath = [&](int cur, int prev) {
+        for ( int v = 0 ; v < n ; ++v ) if ( v != prev && state[cur*n+v] > 0 ) return v;
+        return -1;
+    };
+
+    bool changed = true;
+    while ( changed )
+    {
+        changed = false;
+
+        // degrees: exactly two edges per node
+        for ( int u = 0 ; u < n ; ++u ) {
+            int inCount = 0, freeCount = 0;
+            for ( int v = 0 ; v < n ; ++v ) {
+                if ( state[u*n+v] > 0 ) inCount++;
+                else if ( state[u*n+v] == 0 ) freeCount++;
+            }
+            if ( inCount > 2 || inCount + freeCount < 2 ) return false;
+            if ( freeCount > 0 && ( inCount == 2 || inCount + freeCount == 2 ) ) {
+                signed char s = ( inCount == 2 ) ? -1 : 1; // the other edges out, or the only ones left in
+                for ( int v = 0 ; v < n ; ++v ) {
+                    if ( state[u*n+v] == 0 ) state[u*n+v] = state[v*n+u] = s;
+                }
+                changed = true;
+            }
+            degree[u] = inCount;
+        }
+        if ( changed ) continue; // degrees first, then the paths on stable states
+
+        // paths of fixed edges: the edge joining the two ends would close a subtour (or the tour, if the path has n nodes)
+        std::fill(visited.begin(), visited.end(), 0);
+        for ( int a = 0 ; a < n ; ++a ) {
+            if ( degree[a] != 1 || visited[a] ) continue;
+            int prev = -1, cur = a, count = 1;
+            visited[a] = 1;
+            for ( int next = nextOnPath(cur, prev) ; next >= 0 ; next = nextOnPath(cur, prev) ) {
+                prev = cur;
+                cur = next;
+                visited[cur] = 1;
+                count++;
+            }
+            signed char closing = state[a*n+cur];
+            if ( closing != 0 ) {
+                if ( count == n && closing < 0 ) return false;
+                continue;
+            }
+            state[a*n+cur] = state[cur*n+a] = ( count < n ) ? -1 : 1;
+            changed = true;
+        }
+
+        // nodes with two fixed edges out of the paths are on cycles: only the whole tour is allowed
+        for ( int a = 0 ; a < n ; ++a ) {
+            if ( degree[a] != 2 || visited[a] ) continue;
+            int prev = -1, cur = a, count = 0;
+            do {
+                int next = nextOnPath(cur, prev);
+                visited[cur] = 1;
+                count++;
+                prev = cur;
+                cur = next;
+            } while ( cur != a );
+            if ( count < n ) return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file BranchBound.h
+ * @brief TSP exact solver by branch and bound on 1-tree bounds (parallel, work stealing)
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include "TSPSolution.h"
+#include "OneTree.h"
+
+/**
+ * Class that solves a TSP problem to optimality by depth-first branch and bound:
+ *  - bound of a node: Held-Karp 1-tree bound respecting the edges fixed in or out by the branching,
+ *    the subgradient ascent starts from the penalties of the parent node (few iterations per node)
+ *  - branching: a node v of degree > 2 in the 1-tree and its most expensive free tree edge e,
+ *    children "e out" (explored first) and "e in"; degree and subtour rules fix more edges
+ *  - the initial solution (a tabu search tour) is the first incumbent
+ * Every thread explores its own deque of nodes depth first (last in, first out) and, when it is empty,
+ * steals the oldest node (a large subtree) from the other threads
+ */
+class BranchBoundSolver
+{
+public:
+
+    BranchBoundSolver ( int threads = 1 , int rootIterations = 1000 , int nodeIterations = 50 )
+        : threads(threads) , rootIterations(rootIterations) , nodeIterations(nodeIterations) , nodeCount(0) { }
+
+    /** solve
+     * @param tsp TSP instance
+     * @param initSol initial incumbent (upper bound)
+     * @param bestSol optimal solution
+     * @return optimal value
+     */
+    double solve ( const TSP& tsp , const TSPSolution& initSol , TSPSolution& bestSol );
+
+    long nodes ( ) const { return nodeCount; }   // nodes explored by the last solve
+    double rootBound ( ) const { return root; }  // 1-tree bound at the root node
+
+protected:
+    int threads;
+    int rootIterations;  // subgradient iterations at the root
+    int nodeIterations;  // subgradient iterations at the other nodes (warm started)
+
+    struct Node {
+        std::vector<signed char> state; // edge states, n*n (1 in, -1 out, 0 free)
+        std::vector<double>      pi;    // penalties of the parent
+        double                   bound; // bound of the parent
+        int                      depth;
+    };
+
+    int    n;
+    bool   integral;                   // integer costs: a bound can be rounded up
+    double root;
+    std::atomic<long>   nodeCount;
+    std::atomic<long>   pending;       // nodes created and not yet explored (0: search over)
+    std::atomic<double> upper;         // incumbent value
+    std::mutex          incumbentLock;
+    std::vector<std::deque<Node>> work;
+    std::vector<std::mutex>       workLock;
+
+    bool pruned ( double bound ) const {
+        if ( integral ) bound = std::ceil(bound - 1e-6);
+        return bound >= upper.load() - 1e-9;
+    }
+
+    void explore ( const TSP& tsp , OneTree& tree , Node& node , int t , TSPSolution& bestSol );
+    void push ( int t , Node&& node );
+    bool take ( int t , Node& node );
+
+    /// fix edge (u,v) in or out, then the consequences; false if no tour is left
+    bool fix ( std::vector<signed char>& state , int u , int v , signed char s ) const;
+    bool propagate ( std::vector<signed char>& state ) const;
+};
@@ -0,0 +1,64 @@
+/**
+ * @file Budget.h
+ * @brief time budget and cancellation of a search
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+
+/**
+ * Class that tells a search loop when to stop: wall-clock and CPU time limits, and a cancellation flag that a
+ * signal handler or another thread can set (std::atomic<bool> is lock-free, so it may be written from a handler).
+ * exhausted() is called once per iteration: the flag is read every time, the clocks only every 'stride' calls,
+ * with the stride doubled or halved so that they are read about every CHECK_SECONDS whatever an iteration costs
+ */
+class SearchBudget
+{
+public:
+    SearchBudget ( ) : wallSeconds(0) , cpuSeconds(0) , cancel(nullptr) ,
+                       wallStart(std::chrono::steady_clock::now()) , cpuStart(std::clock()) , stride(1) , left(1) , lastRead(0) { }
+
+    double                   wallSeconds; // limits in seconds (0: none)
+    double                   cpuSeconds;
+    const std::atomic<bool>* cancel;      // stop as soon as it is true (nullptr: none)
+
+    bool limited ( ) const { return wallSeconds > 0 || cpuSeconds > 0; }
+    bool cancelled ( ) const { return cancel && cancel->load(std::memory_order_relaxed); }
+
+    /// start of the search: the limits count from now
+    void start ( ) {
+        wallStart = std::chrono::steady_clock::now();
+        cpuStart = std::clock();
+        stride = left = 1;
+        lastRead = 0;
+    }
+
+    double wall ( ) const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count(); }
+    double cpu ( ) const { return double(std::clock() - cpuStart) / CLOCKS_PER_SEC; }
+
+    /// @return true if the search must stop (flag set or a limit reached)
+    bool exhausted ( ) {
+        if ( cancelled() ) return true;
+        if ( !limited() || --left > 0 ) return false;
+        double now = wall();
+        if ( now - lastRead < CHECK_SECONDS / 2 && stride < MAX_STRIDE ) stride *= 2;
+        else if ( now - lastRead > CHECK_SECONDS && stride > 1 ) stride /= 2;
+        left = stride;
+        lastRead = now;
+        return ( wallSeconds > 0 && now >= wallSeconds ) || ( cpuSeconds > 0 && cpu() >= cpuSeconds );
+    }
+
+private:
+    static constexpr double CHECK_SECONDS = 1e-3;
+    static constexpr int    MAX_STRIDE    = 1 << 16;
+
+    std::chrono::steady_clock::time_point wallStart;
+    std::clock_t                          cpuStart;
+    int    stride;   // calls between two clock reads
+    int    left;     // calls before the next read
+    double lastRead; // wall time of the last read
+};
@@ -0,0 +1,116 @@
+/**
+ * @file CandidateList.h
+ * @brief TSP candidate lists
+ *
+ */
+
+#pragma once
+
+#include "TSP.h"
+#include "OneTree.h"
+
+/**
+ * Class that stores, for each node, its k most promising neighbours (best first).
+ * Neighbourhood scans and constructive methods only look at these edges instead of all the n-1.
+ * Neighbours are ranked by cost (buildNearest) or by alpha-nearness (buildAlpha): alpha(i,j) is the increase of the
+ * minimum 1-tree length when the 1-tree is forced to contain the edge (i,j), so the edges of the optimal tour have
+ * small alphas even when they are not among the nearest ones (Helsgaun)
+ */
+class CandidateList
+{
+public:
+    CandidateList() : n(0) , k(0) { }
+
+    enum Rule { NEAREST , ALPHA }; // ranking of the neighbours
+    int n; // number of nodes
+    int k; // neighbours per node
+    std::vector<int> list; // neighbours of node i in list[i*k] ... list[i*k+k-1]
+
+    const int* neighbors ( int i ) const { return &list[i*k]; }
+
+    /// K neighbours per node by the given rule (alpha: 1-tree improved by 100 subgradient steps from the tour value upper)
+    void build ( const TSP& tsp , int K , Rule rule , double upper )
+    {
+        if ( rule == ALPHA ) buildAlpha(tsp, K, upper, 100);
+        else buildNearest(tsp, K);
+    }
+
+    void buildNearest ( const TSP& tsp , int K ) // the K nearest nodes by cost
+    {
+        n = tsp.n;
+        k = std::max(0, std::min(K, n - 1));
+        list.resize(n*k);
+
+        std::vector<int> V(n);
+        for (int i = 0; i < n; i++) {
+            std::iota(V.begin(), V.end(), 0);
+            std::swap(V[i], V[n-1]); // exclude i itself
+            auto closer = [&](int a, int b){ return tsp.cost[i][a] < tsp.cost[i][b]; };
+            std::nth_element(V.begin(), V.begin() + k, V.end() - 1, closer);
+            std::sort(V.begin(), V.begin() + k, closer);
+            std::copy(V.begin(), V.begin() + k, list.begin() + i*k);
+        }
+    }
+
+    /** the K nodes of smallest alpha-nearness (ties by cost), O(n^2) time and O(n) memory besides the lists
+     * @param tsp TSP instance
+     * @param K neighbours per node
+     * @param upper value of a known tour: if > 0, 'iterations' subgradient steps improve the 1-tree first
+     * @param iterations subgradient iterations (penalties pi, the alphas are computed on c(i,j) + pi(i) + pi(j))
+     * @return ---
+     */
+    void buildAlpha ( const TSP& tsp , int K , double upper = 0 , int iterations = 0 )
+    {
+        n = tsp.n;
+        if ( n < 5 ) { buildNearest(tsp, K); return; }
+        k = std::max(0, std::min(K, n - 1));
+        list.resize(n*k);
+
+        OneTree tree(tsp);
+        std::vector<double> pi(n, 0.0);
+        if ( upper > 0 && iterations > 0 ) tree.ascent(pi, upper, iterations);
+        else tree.build(pi);
+        auto w = [&](int a, int b) { // same rounding for (a,b) and (b,a)
+            if ( a > b ) std::swap(a, b);
+            return tsp.cost[a][b] + pi[a] + pi[b];
+        };
+        const std::vector<int>& dad = tree.parent;
+        double zeroMax = w(0, tree.zeroB); // the larger of the two edges of node 0
+
+        std::vector<double> beta(n); // beta[j]: largest edge on the tree path from i to j
+        std::vector<int>    mark(n, -1);
+        std::vector<double> alpha(n);
+        std::vector<int>    V(n);
+        for ( int i = 0 ; i < n ; ++i ) {
+            if ( i == 0 ) { // node 0 is out of the tree: adding (0,j) replaces its larger edge
+                for ( int j = 1 ; j < n ; ++j )
+                    alpha[j] = ( j == tree.zeroA || j == tree.zeroB ) ? 0 : w(0, j) - zeroMax;
+            }
+            else {
+                // path from i to the root first, then every other node from its parent (tree order)
+                beta[i] = -HUGE_VAL;
+                mark[i] = i;
+                for ( int v = i ; v != 1 ; v = dad[v] ) {
+                    beta[dad[v]] = std::max(beta[v], w(v, dad[v]));
+                    mark[dad[v]] = i;
+                }
+                for ( int q = 1 ; q < n - 1 ; ++q ) {
+                    int j = tree.order[q];
+                    if ( mark[j] != i ) beta[j] = std::max(beta[dad[j]], w(j, dad[j]));
+                }
+                for ( int j = 1 ; j < n ; ++j ) alpha[j] = ( j == i ) ? 0 : w(i, j) - beta[j];
+                alpha[0] = ( i == tree.zeroA || i == tree.zeroB ) ? 0 : w(0, i) - zeroMax;
+            }
+
+            std::iota(V.begin(), V.end(), 0);
+            std::swap(V[i], V[n-1]); // exclude i itself
+            auto better = [&](int a, int b) {
+                if ( alpha[a] != alpha[b] ) return alpha[a] < alpha[b];
+                return tsp.cost[i][a] < tsp.cost[i][b];
+            };
+            std::nth_element(V.begin(), V.begin() + k, V.end() - 1, better);
+            std::sort(V.begin(), V.begin() + k, better);
+            std::copy(V.begin(), V.begin() + k, list.begin() + i*k);
+        }
+    }
+};
@@ -0,0 +1,181 @@
+/**
+ * @file CandidateLocalSearch.cpp
+ * @brief TSP local search on candidate lists for large coordinate instances (2-opt + Or-opt, no cost matrix)
+ *
+ */
+
+#include "CandidateLocalSearch.h"
+#include "SpatialGrid.h"
+#include <thread>
+
+void CandidateLocalSearch::buildNeighbors ( int threads )
+{
+    x.resize(n);
+    y.resize(n);
+    for ( int v = 0 ; v < n ; ++v ) { x[v] = tsp.coord[v][0]; y[v] = tsp.coord[v][1]; }
+    K = std::max(0, std::min(K, n - 1));
+    nbr.assign((size_t)n * K, 0);
+
+    std::vector<int> nodes(n);
+    std::iota(nodes.begin(), nodes.end(), 0);
+    SpatialGrid grid(tsp);
+    grid.build(nodes);
+
+    int nThreads = std::max(1, std::min(threads, n));
+    auto run = [&] (int t) {
+        std::vector<int> near;
+        for ( int v = t ; v < n ; v += nThreads ) {
+            grid.nearestK(v, K, near);
+            std::copy(near.begin(), near.end(), nbr.begin() + (size_t)v * K);
+        }
+    };
+    if ( nThreads == 1 ) run(0);
+    else {
+        std::vector<std::thread> pool;
+        for ( int t = 0 ; t < nThreads ; ++t ) pool.emplace_back(run, t);
+        for ( auto& th : pool ) th.join();
+    }
+}
+
+void CandidateLocalSearch::setNeighbors ( const std::vector<int>& lists )
+{
+    x.resize(n);
+    y.resize(n);
+    for ( int v = 0 ; v < n ; ++v ) { x[v] = tsp.coord[v][0]; y[v] = tsp.coord[v][1]; }
+    K = n ? lists.size() / n : 0;
+    nbr = lists;
+}
+
+double CandidateLocalSearch::improve ( TSPSolution& sol )
+{
+    std::vector<int> order(sol.sequence.begin(), sol.sequence.begin() + n);
+    improve(order, std::vector<int>());
+    std::rotate(order.begin(), std::find(order.begin(), order.end(), 0), order.end());
+    std::copy(order.begin(), order.end(), sol.sequence.begin());
+    sol.sequence[n] = 0;
+    return length(sol);
+}
+
+void CandidateLocalSearch::improve ( std::vector<int>& order , const std::vector<int>& first )
+{
+    if ( n < 5 ) return;
+    tour = order;
+    pos.resize(n);
+    for ( int k = 0 ; k < n ; ++k ) pos[tour[k]] = k;
+
+    queued.assign(n, 0);
+    queue.clear();
+    head = 0;
+    if ( first.empty() ) for ( int v : tour ) push(v);
+    else for ( int v : first ) push(v);
+
+    while ( head < queue.size() ) {
+        int t = queue[head++];
+        queued[t] = 0;
+        if ( twoOpt(t) || orOpt(t) ) push(t); // improved: look at t again
+        if ( head > (size_t)n && head * 2 > queue.size() ) { // drop the processed part of the queue
+            queue.erase(queue.begin(), queue.begin() + head);
+            head = 0;
+        }
+    }
+    order = tour;
+}
+
+void CandidateLocalSearch::reversePath ( int u , int v )
+{
+    int i = pos[u], j = pos[v];
+    int len = (j - i + n) % n + 1;
+    if ( 2 * len > n ) { // reverse the complement instead
+        int ni = ( j + 1 ) % n;
+        j = ( i - 1 + n ) % n;
+        i = ni;
+        len = n - len;
+    }
+    for ( int k = 0 ; k < len / 2 ; ++k ) {
+        int a = tour[i], b = tour[j];
+        tour[i] = b; pos[b] = i;
+        tour[j] = a; pos[a] = j;
+        i = ( i + 1 == n ) ? 0 : i + 1;
+        j = ( j == 0 ) ? n - 1 : j - 1;
+    }
+}
+
+void CandidateLocalSearch::make2opt ( int a , int b , int c , int d )
+{
+    if ( succ(a) == b ) reversePath(b, c); // a b ... c d  ->  a c ... b d
+    else reversePath(a, d);                // b a ... d c  ->  b d ... a c
+    push(a); push(b); push(c); push(d);
+}
+
+bool CandidateLocalSearch::twoOpt ( int t1 )
+{
+    for ( int dir = 0 ; dir < 2 ; ++dir ) {
+        int t2 = dir ? pred(t1) : succ(t1);
+        if ( isFixed(t1, t2) ) continue;
+        double d12 = dist(t1, t2);
+        const int* near = &nbr[(size_t)t2 * K];
+        for ( int q = 0 ; q < K ; ++q ) {
+            int t3 = near[q];
+            double g1 = d12 - dist(t2, t3);
+            if ( g1 <= 1e-9 ) break; // neighbours sorted: no gain from the farther ones
+            int t4 = dir ? succ(t3) : pred(t3);
+            if ( t3 == t1 || t4 == t2 || isFixed(t3, t4) ) continue;
+            if ( g1 + dist(t3, t4) - dist(t4, t1) > 1e-9 ) {
+                make2opt(t1, t2, t4, t3);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool CandidateLocalSearch::orOpt ( int t )
+{
+    for ( int k = 1 ; k <= 3 ; ++k ) {
+        if ( moveSegment(t, k) ) return true; // t first node of the segment
+        if ( k > 1 ) {                        // t last node of the segment
+            int s1 = t;
+            for ( int m = 1 ; m < k ; ++m ) s1 = pred(s1);
+            if ( moveSegment(s1, k) ) return true;
+        }
+    }
+    return false;
+}
+
+bool CandidateLocalSearch::moveSegment ( int s1 , int k )
+{
+    if ( n < k + 3 ) return false;
+    int s2 = s1;
+    for ( int m = 1 ; m < k ; ++m ) s2 = succ(s2);
+    int p = pred(s1), q = succ(s2);
+    if ( isFixed(p, s1) || isFixed(s2, q) ) return false;
+    double removeGain = dist(p, s1) + dist(s2, q) - dist(p, q);
+    if ( removeGain <= 1e-9 ) return false;
+    auto inSegment = [&](int v) { return (pos[v] - pos[s1] + n) % n < k; };
+
+    for ( int e = 0 ; e < 2 ; ++e ) {
+        int s = e ? s2 : s1;
+        if ( e && s1 == s2 ) break;
+        const int* near = &nbr[(size_t)s * K];
+        for ( int r = 0 ; r < K ; ++r ) {
+            int c = near[r];
+            if ( dist(s, c) >= removeGain ) break;
+            if ( inSegment(c) ) continue;
+            for ( int side = 0 ; side < 2 ; ++side ) {
+                int a = side ? pred(c) : c; // insertion edge (a,b), b = succ(a)
+                int b = succ(a);
+                if ( inSegment(a) || inSegment(b) || b == p || isFixed(a, b) ) continue;
+                double reversed  = dist(a, s2) + dist(s1, b) - dist(a, b);
+                double preserved = dist(a, s1) + dist(s2, b) - dist(a, b);
+                if ( removeGain - std::min(reversed, preserved) <= 1e-9 ) continue;
+
+                // p s1..s2 q ... a b  ->  p q ... a s2..s1 b  (two 2-opt moves)
+                make2opt(p, s1, a, b);
+                if ( a != q ) make2opt(p, a, q, s2);
+                if ( preserved < reversed && s1 != s2 ) make2opt(a, s2, s1, b); // ... a s1..s2 b
+                return true;
+            }
+        }
+    }
+    return false;
+}
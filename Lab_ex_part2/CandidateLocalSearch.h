@@ -0,0 +1,91 @@
+/**
+ * @file CandidateLocalSearch.h
+ * @brief TSP local search on candidate lists for large coordinate instances (2-opt + Or-opt, no cost matrix)
+ *
+ */
+
+#pragma once
+
+#include <cmath>
+#include "TSPSolution.h"
+
+/**
+ * Class that improves a tour of a coordinate instance without the cost matrix: distances come from the
+ * hole positions and the moves are only tried towards the K nearest holes of a node (neighbour lists).
+ * The tour is an array with the position of every node; a 2-opt move reverses the shorter of the two paths.
+ * Nodes are processed from a queue (don't look bits): a node is queued again when one of its edges changes.
+ *  - 2-opt: edges (t1,t2) and (t4,t3) replaced by (t2,t3) and (t1,t4), t3 among the neighbours of t2
+ *  - Or-opt: a segment of 1 ... 3 nodes moved (possibly reversed) between two neighbours of one of its ends
+ */
+class CandidateLocalSearch
+{
+public:
+
+    CandidateLocalSearch ( const TSP& tsp , int K = 8 ) : fixed(NULL) , tsp(tsp) , n(tsp.n) , K(K) { }
+
+    /// edges that no move removes: (v, fixed[2v]) and (v, fixed[2v+1]), -1 if none (NULL: all edges free)
+    const std::vector<int>* fixed;
+
+    /** neighbour lists (K nearest holes of every node, Manhattan distance)
+     * @param threads threads sharing the nodes
+     * @return ---
+     */
+    void buildNeighbors ( int threads = 1 );
+
+    /** neighbour lists given by the caller (same layout as the built ones, K per node)
+     * @param lists neighbours of node v in lists[v*K] ... lists[v*K+K-1], nearest first
+     * @return ---
+     */
+    void setNeighbors ( const std::vector<int>& lists );
+
+    /** descent to a local optimum of 2-opt and Or-opt (needs the neighbour lists)
+     * @param sol tour to improve (in place, still from node 0)
+     * @return length of the improved tour
+     */
+    double improve ( TSPSolution& sol );
+
+    /** descent from a tour given as an order of the nodes, only the given nodes queued (the others are already optimised)
+     * @param order tour (all the n nodes, any start), improved in place
+     * @param first nodes to process first (empty: all)
+     * @return ---
+     */
+    void improve ( std::vector<int>& order , const std::vector<int>& first );
+
+    double dist ( int a , int b ) const { return std::fabs(x[a] - x[b]) + std::fabs(y[a] - y[b]); }
+
+    /// tour length from the positions
+    double length ( const TSPSolution& sol ) const {
+        double total = 0.0;
+        for ( int k = 0 ; k < n ; ++k ) total += dist(sol.sequence[k], sol.sequence[k+1]);
+        return total;
+    }
+
+protected:
+    const TSP& tsp;
+    int n;
+    int K;                  // neighbours per node
+    std::vector<double> x, y;
+    std::vector<int> nbr;   // neighbours of node v in nbr[v*K] ... nbr[v*K+K-1], nearest first
+
+    std::vector<int>  tour; // node at every position
+    std::vector<int>  pos;  // position of every node
+    std::vector<int>  queue;
+    std::vector<char> queued;
+    size_t head;
+
+    int succ ( int v ) const { return tour[pos[v] + 1 == n ? 0 : pos[v] + 1]; }
+    int pred ( int v ) const { return tour[pos[v] == 0 ? n - 1 : pos[v] - 1]; }
+
+    void push ( int v ) { if ( !queued[v] ) { queued[v] = 1; queue.push_back(v); } }
+
+    bool isFixed ( int u , int v ) const { return fixed && ( (*fixed)[2*u] == v || (*fixed)[2*u+1] == v ); }
+
+    /// reverse the path from u forward to v (or the rest of the tour, if shorter: same edges)
+    void reversePath ( int u , int v );
+    /// replace the tour edges (a,b) and (c,d) by (a,c) and (b,d)
+    void make2opt ( int a , int b , int c , int d );
+
+    bool twoOpt ( int t1 );
+    bool orOpt ( int t );
+    bool moveSegment ( int s1 , int k );
+};
@@ -0,0 +1,88 @@
+/**
+ * @file Checkpoint.h
+ * @brief binary files of a search state, replaced atomically
+ *
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+#include <unistd.h>
+
+/// a checkpoint that cannot be written or does not fit the search: the caller must not take the result as complete
+struct CheckpointError : std::runtime_error
+{
+    explicit CheckpointError ( const std::string& what ) : std::runtime_error(what) { }
+};
+
+/**
+ * Class that stores a search state as raw values: the values are appended to a buffer (put), written in one go
+ * to a temporary file that is synced and renamed over the checkpoint (a crash leaves the old checkpoint or the
+ * new one, never half a file), and read back in the same order (get)
+ */
+class Checkpoint
+{
+public:
+    Checkpoint ( ) : offset(0) { }
+
+    template <class T> void put ( const T& value ) { buffer.append((const char*)&value, sizeof(T)); }
+    template <class T> void put ( const std::vector<T>& values ) {
+        put<uint64_t>(values.size());
+        buffer.append((const char*)values.data(), values.size() * sizeof(T));
+    }
+
+    template <class T> bool get ( T& value ) {
+        if ( offset + sizeof(T) > buffer.size() ) return false;
+        buffer.copy((char*)&value, sizeof(T), offset);
+        offset += sizeof(T);
+        return true;
+    }
+    template <class T> bool get ( std::vector<T>& values ) {
+        uint64_t size;
+        if ( !get(size) || offset + size * sizeof(T) > buffer.size() ) return false;
+        values.resize(size);
+        buffer.copy((char*)values.data(), size * sizeof(T), offset);
+        offset += size * sizeof(T);
+        return true;
+    }
+
+    /** write the buffer: temporary file, sync, rename over filename
+     * @return true if the checkpoint is on disk
+     */
+    bool save ( const std::string& filename ) const
+    {
+        std::string tmp = filename + ".tmp";
+        std::FILE* f = std::fopen(tmp.c_str(), "wb");
+        if ( !f ) return false;
+        bool ok = std::fwrite(buffer.data(), 1, buffer.size(), f) == buffer.size();
+        ok = ( std::fflush(f) == 0 ) && ok;
+        ok = ( fsync(fileno(f)) == 0 ) && ok;
+        ok = ( std::fclose(f) == 0 ) && ok;
+        if ( ok ) ok = ( std::rename(tmp.c_str(), filename.c_str()) == 0 );
+        if ( !ok ) std::remove(tmp.c_str());
+        return ok;
+    }
+
+    /** read a whole checkpoint file, the next get returns its first value
+     * @return false if there is no such file
+     */
+    bool load ( const std::string& filename )
+    {
+        std::ifstream in(filename, std::ios::binary);
+        if ( !in ) return false;
+        buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        offset = 0;
+        return true;
+    }
+
+    bool finished ( ) const { return offset == buffer.size(); } // every value read
+
+private:
+    std::string buffer;
+    size_t      offset;
+};
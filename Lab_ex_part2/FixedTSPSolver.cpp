@@ -0,0 +1,25 @@
+/**
+ * @file FixedTSPSolver.cpp
+ * @brief runtime dispatch to the compile-time board sizes
+ *
+ */
+
+#include "FixedTSPSolver.h"
+
+template <int N>
+static bool solveWith ( const TSP& tsp , const TSPSolution& initSol , int tabulength , int maxIter , TSPSolution& bestSol ,
+                        double lowerBound )
+{
+    static thread_local FixedTSPSolver<N> solver; // one per size and thread, reused by the next solves
+    return solver.solve(tsp, initSol, tabulength, maxIter, bestSol, lowerBound);
+}
+
+bool solveFixed ( const TSP& tsp , const TSPSolution& initSol , int tabulength , int maxIter , TSPSolution& bestSol ,
+                  double lowerBound )
+{
+    if ( tsp.n <= 16 )  return solveWith<16>(tsp, initSol, tabulength, maxIter, bestSol, lowerBound);
+    if ( tsp.n <= 32 )  return solveWith<32>(tsp, initSol, tabulength, maxIter, bestSol, lowerBound);
+    if ( tsp.n <= 64 )  return solveWith<64>(tsp, initSol, tabulength, maxIter, bestSol, lowerBound);
+    if ( tsp.n <= 128 ) return solveWith<128>(tsp, initSol, tabulength, maxIter, bestSol, lowerBound);
+    return false;
+}
@@ -0,0 +1,167 @@
+/**
+ * @file FixedTSPSolver.h
+ * @brief TSP tabu search specialised on a compile-time board size (small boards, no heap)
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include "TSPSolution.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Class that solves a TSP problem with at most N nodes by tabu search on 2-opt moves (node tabu rule).
+ * Same search as TSPSolver with the default options (same moves, ties and aspiration, so the same tours),
+ * but everything is in std::arrays of the object: a solve allocates nothing on the heap.
+ * The costs are kept in tour order, P[a][b] = cost between the nodes at positions a and b, so that the
+ * variations of the moves (a, a+1 ... n-1) read two contiguous rows of P (two doubles at a time with SSE2).
+ * A reversal of [from,to] reverses the rows from ... to and the same columns in every row, O(n (to-from)).
+ * The object is large (about 2 N^2 doubles): keep one per thread and reuse it
+ */
+template <int N>
+class FixedTSPSolver
+{
+public:
+    static const int CAPACITY = N;
+
+    /** solve with tabu search
+     * @param tsp TSP instance (tsp.n <= N)
+     * @param initSol initial solution
+     * @param tabulength tabu length (node rule)
+     * @param maxIter iterations
+     * @param bestSol best solution found
+     * @param lowerBound known lower bound: stop when the incumbent meets it
+     * @return true if everything OK, false otherwise
+     */
+    bool solve ( const TSP& tsp , const TSPSolution& initSol , int tabulength , int maxIter , TSPSolution& bestSol ,
+                 double lowerBound = -HUGE_VAL )
+    {
+        n = tsp.n;
+        if ( n > N ) return false;
+        infinite = tsp.infinite;
+        for ( int k = 0 ; k <= n ; ++k ) curr[k] = best[k] = initSol.sequence[k];
+        for ( int a = 0 ; a <= n ; ++a ) {
+            const std::vector<double>& row = tsp.cost[curr[a]];
+            for ( int b = 0 ; b <= n ; ++b ) P[a*S + b] = row[curr[b]];
+        }
+        last.fill(std::numeric_limits<int>::min() / 2);
+        tabuLength = tabulength;
+
+        double initValue = 0.0, bestValue, currValue;
+        for ( int k = 0 ; k < n ; ++k ) initValue += P[k*S + k+1];
+        bestValue = currValue = initValue;
+        int from = 0, to = 0;
+
+        for ( int iter = 1 ; iter <= maxIter + 1 && bestValue > lowerBound + 1e-9 ; ++iter ) {
+            double aspiration = bestValue - currValue;
+            double variation = bestMove(iter, aspiration, from, to);
+            if ( variation >= infinite ) break; // all neighbours are tabu
+
+            last[curr[from]] = iter;
+            last[curr[to]] = iter;
+            reverse(from, to);
+            currValue = currValue + variation;
+
+            if ( currValue < bestValue - 0.01 ) {
+                bestValue = currValue;
+                best = curr;
+            }
+        }
+
+        if ( initValue == bestValue ) bestSol = initSol;
+        else {
+            for ( int k = 0 ; k <= n ; ++k ) bestSol.sequence[k] = best[k];
+        }
+        return true;
+    }
+
+private:
+    static const int S = N + 1;     // row stride of P (positions 0 ... n)
+
+    int n;
+    int tabuLength;
+    double infinite;
+    std::array<double, S*S> P;      // costs in tour order
+    std::array<int, N+1>    curr;
+    std::array<int, N+1>    best;
+    std::array<int, N>      last;   // node rule: last iteration each node was moved
+    std::array<double, N>   next;   // next[b] = P[b][b+1], cost of the tour edge from position b
+    std::array<char, N>     tabu;   // tabu[b]: the node at position b is tabu
+
+    void reverse ( int from , int to ) {
+        std::reverse(curr.begin() + from, curr.begin() + to + 1);
+        for ( int a = 0 ; a <= n ; ++a ) std::reverse(&P[a*S + from], &P[a*S + to + 1]);
+        for ( int a = from , b = to ; a < b ; ++a , --b ) std::swap_ranges(&P[a*S], &P[a*S + n + 1], &P[b*S]);
+    }
+
+    /// smallest of - removed - next[b] + H[b] + I[b+1] for b = b0 ... n-1 (same operations as the scalar variation)
+    double rowMinimum ( double removed , const double* H , const double* I , int b0 ) const {
+        double rowMin = infinite;
+        int b = b0;
+#ifdef __SSE2__
+        __m128d vMin = _mm_set1_pd(infinite);
+        const __m128d vRemoved = _mm_set1_pd(-removed);
+        for ( ; b + 1 < n ; b += 2 ) {
+            __m128d v = _mm_sub_pd(vRemoved, _mm_loadu_pd(&next[b]));
+            v = _mm_add_pd(_mm_add_pd(v, _mm_loadu_pd(H + b)), _mm_loadu_pd(I + b + 1));
+            vMin = _mm_min_pd(vMin, v);
+        }
+        double lanes[2];
+        _mm_storeu_pd(lanes, vMin);
+        rowMin = std::min(lanes[0], lanes[1]);
+#endif
+        for ( ; b < n ; ++b ) rowMin = std::min(rowMin, - removed - next[b] + H[b] + I[b+1]);
+        return rowMin;
+    }
+
+    /// best non-tabu 2-opt move (same order and ties as TSPSolver::scanNeighbors)
+    double bestMove ( int iter , double aspiration , int& from , int& to )
+    {
+        for ( int b = 0 ; b < n ; ++b ) {
+            next[b] = P[b*S + b+1];
+            tabu[b] = iter - last[curr[b]] <= tabuLength;
+        }
+
+        double bestVariation = infinite;
+        for ( int a = 1 ; a < n - 1 ; ++a ) {
+            const double* H = &P[(a-1)*S];
+            const double* I = &P[a*S];
+            double removed = next[a-1];
+
+            if ( !tabu[a] ) { // no tabu move in this row: minimum first, then its first position
+                double rowMin = rowMinimum(removed, H, I, a + 1);
+                if ( rowMin < bestVariation ) {
+                    int b = a + 1;
+                    while ( - removed - next[b] + H[b] + I[b+1] != rowMin ) ++b;
+                    bestVariation = rowMin;
+                    from = a;
+                    to = b;
+                }
+                continue;
+            }
+            for ( int b = a + 1 ; b < n ; ++b ) {
+                double variation = - removed - next[b] + H[b] + I[b+1] ;
+                if ( tabu[b] && !(variation < aspiration-0.01) ) continue;
+                if ( variation < bestVariation ) {
+                    bestVariation = variation;
+                    from = a;
+                    to = b;
+                }
+            }
+        }
+        return bestVariation;
+    }
+};
+
+/** solve with the smallest instantiated FixedTSPSolver that fits the instance (16, 32, 64 or 128 nodes)
+ * @return false if the instance is too large (nothing done)
+ */
+bool solveFixed ( const TSP& tsp , const TSPSolution& initSol , int tabulength , int maxIter , TSPSolution& bestSol ,
+                  double lowerBound = -HUGE_VAL );
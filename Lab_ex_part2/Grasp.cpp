@@ -0,0 +1,103 @@
+/**
+ * @file Grasp.cpp
+ * @brief TSP GRASP solver (randomised nearest neighbour + 2-opt descent)
+ *
+ */
+
+#include "Grasp.h"
+#include <thread>
+
+bool GraspSolver::solve ( const TSP& tsp , const TSPSolution& initSol , int iterations , TSPSolution& bestSol )
+{
+    try
+    {
+        bestSol = initSol;
+        double bestValue = solver.evaluate(bestSol, tsp);
+        if ( tsp.n < 4 ) return true;
+
+        cand.build(tsp, std::max(candidates, rcl), candidateRule, bestValue);
+        int nThreads = std::max(1, std::min(threads, iterations));
+
+        std::vector<TSPSolution> threadBest(nThreads, initSol);
+        std::vector<double> threadValue(nThreads, bestValue);
+
+        BatchEvaluator evaluator(tsp);
+        auto run = [&] (int t) {
+            Rng rng(Rng::THREADS + t); // stream of the thread: same tours for the same seed and threads
+            std::vector<char> visited(tsp.n);
+            TSPSolution sol(tsp);
+            // constructions by blocks, evaluated together, then the descents
+            TourBatch batch;
+            batch.reset(tsp.n, BatchEvaluator::BLOCK * 2);
+            double start[BatchEvaluator::BLOCK * 2];
+            for ( int it = t ; it < iterations ; ) {
+                batch.clear();
+                for ( ; it < iterations && !batch.full() ; it += nThreads ) {
+                    construct(tsp, rng, visited, sol);
+                    batch.store(batch.size, sol);
+                }
+                evaluator.evaluate(batch, start);
+                for ( int b = 0 ; b < batch.size ; ++b ) {
+                    batch.load(b, sol);
+                    double value = ls.twoOpt(tsp, sol, start[b]);
+                    if ( value < threadValue[t] - 0.01 ) {
+                        threadValue[t] = value;
+                        threadBest[t] = sol;
+                    }
+                }
+            }
+        };
+        if ( nThreads == 1 ) run(0);
+        else {
+            std::vector<std::thread> pool;
+            for ( int t = 0 ; t < nThreads ; ++t ) pool.emplace_back(run, t);
+            for ( auto& th : pool ) th.join();
+        }
+
+        for ( int t = 0 ; t < nThreads ; ++t ) {
+            if ( threadValue[t] < bestValue ) {
+                bestValue = threadValue[t];
+                bestSol = threadBest[t];
+            }
+        }
+    }
+    catch(std::exception& e){
+        std::cout << ">>>EXCEPTION: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void GraspSolver::construct ( const TSP& tsp , Rng& rng , std::vector<char>& visited , TSPSolution& sol ) const
+{
+    int n = tsp.n;
+    int size = std::max(1, rcl);
+    std::vector<int> list(size);
+
+    std::fill(visited.begin(), visited.end(), 0);
+    visited[0] = 1;
+    int cur = 0;
+
+    for ( int step = 1 ; step < n ; ++step ) {
+        // restricted candidate list: the first 'size' unvisited nodes of the sorted neighbour list
+        int found = 0;
+        const int* c = cand.neighbors(cur);
+        for ( int q = 0 ; q < cand.k && found < size ; ++q ) {
+            if ( !visited[c[q]] ) list[found++] = c[q];
+        }
+        if ( found == 0 ) { // neighbour list exhausted: nearest unvisited node
+            for ( int j = 0 ; j < n ; ++j ) {
+                if ( !visited[j] && ( found == 0 || tsp.cost[cur][j] < tsp.cost[cur][list[0]] ) ) {
+                    list[0] = j;
+                    found = 1;
+                }
+            }
+        }
+
+        int next = list[rng.below(found)];
+        sol.sequence[step] = next;
+        visited[next] = 1;
+        cur = next;
+    }
+    sol.sequence[0] = sol.sequence[n] = 0;
+}
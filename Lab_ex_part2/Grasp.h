@@ -0,0 +1,54 @@
+/**
+ * @file Grasp.h
+ * @brief TSP GRASP solver (randomised nearest neighbour + 2-opt descent)
+ *
+ */
+
+#pragma once
+
+#include "TSPSolver.h"
+#include "LocalSearch.h"
+#include "CandidateList.h"
+#include "BatchEvaluator.h"
+
+/**
+ * Class that solves a TSP problem by GRASP: every iteration builds a solution by a randomised
+ * nearest neighbour (next node chosen at random among the 'rcl' closest unvisited nodes,
+ * the restricted candidate list) and improves it by 2-opt descent.
+ * Iterations are split among 'threads' threads, each with its own random stream
+ */
+class GraspSolver
+{
+public:
+
+    GraspSolver ( int rcl = 3 , int threads = 1 , int candidates = 50 )
+        : candidateRule(CandidateList::NEAREST) , rcl(rcl) , threads(threads) , candidates(candidates) { }
+
+    CandidateList::Rule candidateRule; // neighbours by cost or by alpha-nearness
+
+    /** solve
+     * @param tsp TSP instance
+     * @param initSol initial solution (kept if no iteration finds a better one)
+     * @param iterations number of construction + descent iterations
+     * @param bestSol best solution found
+     * @return true if no exception
+     */
+    bool solve ( const TSP& tsp , const TSPSolution& initSol , int iterations , TSPSolution& bestSol );
+
+    /** randomised nearest neighbour construction (needs the sorted neighbour lists built by solve)
+     * @param tsp TSP instance
+     * @param rng random stream
+     * @param visited buffer of n flags
+     * @param sol built solution
+     */
+    void construct ( const TSP& tsp , Rng& rng , std::vector<char>& visited , TSPSolution& sol ) const;
+
+protected:
+    int rcl;        // restricted candidate list length (1: deterministic nearest neighbour)
+    int threads;
+    int candidates; // length of the precomputed sorted neighbour lists
+
+    TSPSolver     solver; // evaluate()
+    LocalSearch   ls;
+    CandidateList cand;
+};
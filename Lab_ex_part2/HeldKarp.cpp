@@ -0,0 +1,125 @@
+/**
+ * @file HeldKarp.cpp
+ * @brief TSP exact solver by dynamic programming on subsets (Held-Karp), small instances
+ *
+ */
+
+#include "HeldKarp.h"
+#include <thread>
+#include <limits>
+#include <cmath>
+#include <stdexcept>
+
+double HeldKarpSolver::solve ( const TSP& tsp , TSPSolution& bestSol )
+{
+    int n = tsp.n;
+    if ( n > HELD_KARP_MAX_NODES ) throw std::runtime_error("Held-Karp: too many nodes (at most " + std::to_string(HELD_KARP_MAX_NODES) + ")");
+    if ( n <= 3 ) { // a single tour
+        for ( int k = 0 ; k < n ; ++k ) bestSol.sequence[k] = k;
+        bestSol.sequence[n] = 0;
+        double value = 0.0;
+        for ( int k = 0 ; k < n ; ++k ) value += tsp.cost[bestSol.sequence[k]][bestSol.sequence[k+1]];
+        return value;
+    }
+
+    // smallest cost type that holds every path length exactly
+    bool integer = true;
+    double maxCost = 0.0;
+    for ( int i = 0 ; i < n ; ++i ) {
+        for ( int j = 0 ; j < n ; ++j ) {
+            double c = tsp.cost[i][j];
+            if ( c < 0 || c != std::floor(c) ) integer = false;
+            maxCost = std::max(maxCost, c);
+        }
+    }
+    if ( integer && maxCost * n < std::numeric_limits<uint16_t>::max() ) return run<uint16_t>(tsp, bestSol);
+    if ( integer && maxCost * n < std::numeric_limits<uint32_t>::max() ) return run<uint32_t>(tsp, bestSol);
+    return run<double>(tsp, bestSol);
+}
+
+template <class Cost>
+double HeldKarpSolver::run ( const TSP& tsp , TSPSolution& bestSol )
+{
+    // nodes 1 ... n-1 are bits 0 ... m-1 of a subset
+    const int n = tsp.n;
+    const int m = n - 1;
+    const uint32_t subsets = 1u << m;
+    const uint32_t full = subsets - 1;
+
+    std::vector<Cost> c(n*n);
+    for ( int i = 0 ; i < n ; ++i ) {
+        for ( int j = 0 ; j < n ; ++j ) c[i*n + j] = (Cost)tsp.cost[i][j];
+    }
+
+    // subsets ordered by size (counting sort on the number of nodes)
+    std::vector<uint32_t> first(m + 2, 0);
+    for ( uint32_t S = 1 ; S < subsets ; ++S ) first[__builtin_popcount(S) + 1]++;
+    for ( int k = 1 ; k <= m + 1 ; ++k ) first[k] += first[k-1];
+    std::vector<uint32_t> bySize(subsets);
+    {
+        std::vector<uint32_t> fill(first.begin(), first.end() - 1);
+        for ( uint32_t S = 1 ; S < subsets ; ++S ) bySize[fill[__builtin_popcount(S)]++] = S;
+    }
+
+    std::vector<Cost> f((size_t)subsets * m);
+    for ( int j = 0 ; j < m ; ++j ) f[((size_t)1 << j) * m + j] = c[j+1];
+
+    auto level = [&] (uint32_t from, uint32_t to) {
+        for ( uint32_t q = from ; q < to ; ++q ) {
+            uint32_t S = bySize[q];
+            Cost* fS = &f[(size_t)S * m];
+            for ( uint32_t r = S ; r ; r &= r - 1 ) {
+                int j = __builtin_ctz(r);
+                uint32_t P = S ^ (1u << j);
+                const Cost* fP = &f[(size_t)P * m];
+                const Cost* cj = &c[j+1]; // cj[(i+1)*n] = c(i+1, j+1)
+                Cost best = std::numeric_limits<Cost>::max();
+                for ( uint32_t s = P ; s ; s &= s - 1 ) {
+                    int i = __builtin_ctz(s);
+                    Cost v = fP[i] + cj[(i+1)*n];
+                    if ( v < best ) best = v;
+                }
+                fS[j] = best;
+            }
+        }
+    };
+
+    for ( int k = 2 ; k <= m ; ++k ) {
+        uint32_t begin = first[k], end = first[k+1];
+        int nThreads = std::max(1, std::min<int>(threads, (end - begin) / 4096));
+        if ( nThreads == 1 ) level(begin, end);
+        else {
+            std::vector<std::thread> pool;
+            uint32_t chunk = (end - begin + nThreads - 1) / nThreads;
+            for ( int t = 0 ; t < nThreads ; ++t ) {
+                uint32_t a = begin + t * chunk;
+                pool.emplace_back(level, a, std::min(end, a + chunk));
+            }
+            for ( auto& th : pool ) th.join();
+        }
+    }
+
+    // close the tour, then follow the recursion back
+    const Cost* fFull = &f[(size_t)full * m];
+    int last = 0;
+    Cost best = fFull[0] + c[1*n];
+    for ( int j = 1 ; j < m ; ++j ) {
+        Cost v = fFull[j] + c[(j+1)*n];
+        if ( v < best ) { best = v; last = j; }
+    }
+
+    bestSol.sequence[0] = bestSol.sequence[n] = 0;
+    uint32_t S = full;
+    for ( int pos = n - 1 ; pos >= 1 ; --pos ) {
+        bestSol.sequence[pos] = last + 1;
+        uint32_t P = S ^ (1u << last);
+        if ( P == 0 ) break;
+        Cost target = f[(size_t)S * m + last];
+        for ( uint32_t s = P ; s ; s &= s - 1 ) {
+            int i = __builtin_ctz(s);
+            if ( (Cost)(f[(size_t)P * m + i] + c[(i+1)*n + last+1]) == target ) { last = i; break; }
+        }
+        S = P;
+    }
+    return (double)best;
+}
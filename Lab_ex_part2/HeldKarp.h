@@ -0,0 +1,40 @@
+/**
+ * @file HeldKarp.h
+ * @brief TSP exact solver by dynamic programming on subsets (Held-Karp), small instances
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "TSPSolution.h"
+
+#define HELD_KARP_MAX_NODES 24 // 2^(n-1) (n-1) table entries: about 200M for n = 24
+
+/**
+ * Class that solves a TSP problem to optimality by the Held-Karp recursion
+ *   f(S, j) = min { f(S - j, i) + c(i, j) : i in S - j }
+ * = length of the shortest path from node 0 through the nodes of S, ending in j in S.
+ * The table is subset-major (the n-1 values of a subset are contiguous), the subsets are
+ * processed by size (every size only reads the previous one, so a size is split among threads).
+ * Integer costs are stored as uint16_t or uint32_t when the tour length fits, halving or quartering the table
+ */
+class HeldKarpSolver
+{
+public:
+
+    HeldKarpSolver ( int threads = 1 ) : threads(threads) { }
+
+    /** solve
+     * @param tsp TSP instance (n <= HELD_KARP_MAX_NODES)
+     * @param bestSol optimal solution
+     * @return optimal value
+     */
+    double solve ( const TSP& tsp , TSPSolution& bestSol );
+
+protected:
+    int threads;
+
+    template <class Cost>
+    double run ( const TSP& tsp , TSPSolution& bestSol );
+};
@@ -0,0 +1,216 @@
+/**
+ * @file Incremental.cpp
+ * @brief TSP re-optimisation of a tour after a board revision (holes added, moved or removed)
+ *
+ */
+
+#include "Incremental.h"
+#include "CandidateLocalSearch.h"
+#include "SpatialGrid.h"
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+bool BoardDiff::read ( const char* filename )
+{
+    std::ifstream in(filename);
+    if ( !in ) return false;
+    std::string line;
+    while ( std::getline(in, line) ) {
+        std::istringstream words(line);
+        std::string what;
+        if ( !(words >> what) ) continue; // empty line
+        int id;
+        double x, y;
+        if ( what == "remove" && words >> id ) removed.push_back(id);
+        else if ( what == "move" && words >> id >> x >> y ) { moved.push_back(id); movedTo.push_back({x, y}); }
+        else if ( what == "add" && words >> x >> y ) added.push_back({x, y});
+        else return false;
+    }
+    return true;
+}
+
+double IncrementalSolver::apply ( TSP& tsp , TSPSolution& sol , const BoardDiff& diff )
+{
+    if ( tsp.coord.empty() ) throw std::runtime_error("a board revision needs hole positions");
+    auto manhattan = [&](int a, int b) {
+        return std::fabs(tsp.coord[a][0] - tsp.coord[b][0]) + std::fabs(tsp.coord[a][1] - tsp.coord[b][1]);
+    };
+    auto lineSums = [&](int k) { // row and column of hole k, as counted in tsp.infinite
+        double total = 0.0;
+        for ( int j = 0 ; j < tsp.n ; ++j ) total += tsp.cost[k][j] + tsp.cost[j][k];
+        return 2 * total;
+    };
+
+    // hole of every original id
+    int maxId = *std::max_element(tsp.id.begin(), tsp.id.end());
+    std::vector<int> nodeOf;
+    auto mapIds = [&]() {
+        nodeOf.assign(maxId + 1, -1);
+        for ( int v = 0 ; v < tsp.n ; ++v ) nodeOf[tsp.id[v]] = v;
+    };
+    mapIds();
+    std::vector<char> changed(maxId + 1, 0);
+    std::vector<char> dirty(tsp.n, 0);      // nodes (before the revision) removed or moved
+    std::vector<int>  origin(tsp.n);        // node before the revision of every node (-1: new hole)
+    std::iota(origin.begin(), origin.end(), 0);
+    auto node = [&](int id) {
+        if ( id < 0 || id > maxId || nodeOf[id] < 0 ) throw std::runtime_error("unknown hole " + std::to_string(id));
+        if ( changed[id]++ ) throw std::runtime_error("hole " + std::to_string(id) + " changed twice");
+        return nodeOf[id];
+    };
+
+    // removed and moved holes leave the tour: their neighbours are joined (and looked at later)
+    std::vector<int> tour(sol.sequence.begin(), sol.sequence.end() - 1);
+    std::vector<int> touched; // ids of the holes around the changes
+    auto leave = [&](int v) {
+        int k = std::find(tour.begin(), tour.end(), v) - tour.begin();
+        int m = tour.size();
+        touched.push_back(tsp.id[tour[(k + m - 1) % m]]);
+        touched.push_back(tsp.id[tour[(k + 1) % m]]);
+        tour.erase(tour.begin() + k);
+    };
+    std::vector<int> removed, enter;
+    for ( int id : diff.removed ) removed.push_back(node(id));
+    for ( int v : removed ) dirty[v] = 1;
+    for ( int v : removed ) leave(v);
+
+    // moved holes: new row and column
+    for ( size_t q = 0 ; q < diff.moved.size() ; ++q ) {
+        int v = node(diff.moved[q]);
+        dirty[v] = 1;
+        leave(v);
+        tsp.infinite -= lineSums(v);
+        tsp.coord[v] = diff.movedTo[q];
+        for ( int j = 0 ; j < tsp.n ; ++j ) tsp.cost[v][j] = tsp.cost[j][v] = manhattan(v, j);
+        tsp.infinite += lineSums(v);
+        enter.push_back(tsp.id[v]);
+    }
+
+    // removed holes: the last hole takes the place of each (highest first, so the last one is never removed later)
+    std::sort(removed.rbegin(), removed.rend());
+    for ( int k : removed ) {
+        tsp.infinite -= lineSums(k);
+        int last = tsp.n - 1;
+        if ( k != last ) {
+            std::swap(tsp.cost[k], tsp.cost[last]);
+            for ( int i = 0 ; i < tsp.n ; ++i ) tsp.cost[i][k] = tsp.cost[i][last];
+            tsp.coord[k] = tsp.coord[last];
+            tsp.id[k] = tsp.id[last];
+            origin[k] = origin[last];
+            auto at = std::find(tour.begin(), tour.end(), last); // not in the tour if it was moved: it enters by id
+            if ( at != tour.end() ) *at = k;
+        }
+        for ( int i = 0 ; i < tsp.n ; ++i ) tsp.cost[i].pop_back();
+        tsp.cost.pop_back();
+        tsp.coord.pop_back();
+        tsp.id.pop_back();
+        origin.pop_back();
+        tsp.n--;
+    }
+
+    // new holes: one more row and column each
+    for ( const std::vector<double>& p : diff.added ) {
+        int v = tsp.n++;
+        tsp.coord.push_back(p);
+        tsp.id.push_back(++maxId);
+        for ( int i = 0 ; i < v ; ++i ) tsp.cost[i].push_back(manhattan(i, v));
+        tsp.cost.push_back(std::vector<double>(tsp.n));
+        for ( int j = 0 ; j < tsp.n ; ++j ) tsp.cost[v][j] = manhattan(v, j);
+        tsp.infinite += lineSums(v);
+        origin.push_back(-1);
+        enter.push_back(maxId);
+    }
+    if ( tsp.n < 1 ) throw std::runtime_error("no hole left on the board");
+    mapIds();
+
+    // moved and new holes enter the tour where they cost the least
+    for ( int id : enter ) {
+        int v = nodeOf[id];
+        int m = tour.size();
+        int best = 0;
+        double bestCost = HUGE_VAL;
+        for ( int k = 0 ; k < m && m > 1 ; ++k ) {
+            int a = tour[k], b = tour[(k + 1) % m];
+            double c = tsp.cost[a][v] + tsp.cost[v][b] - tsp.cost[a][b];
+            if ( c < bestCost ) { bestCost = c; best = k + 1; }
+        }
+        tour.insert(tour.begin() + best, v);
+        touched.push_back(id);
+    }
+
+    // local search from the holes around the changes
+    std::vector<int> first;
+    for ( int id : touched ) if ( nodeOf[id] >= 0 ) first.push_back(nodeOf[id]);
+    updateNeighbors(tsp, origin, dirty);
+    CandidateLocalSearch ls(tsp, neighbors);
+    ls.setNeighbors(nbr);
+    ls.improve(tour, first);
+
+    std::rotate(tour.begin(), std::find(tour.begin(), tour.end(), 0), tour.end());
+    sol.sequence.assign(tour.begin(), tour.end());
+    sol.sequence.push_back(0);
+    return ls.length(sol);
+}
+
+void IncrementalSolver::updateNeighbors ( const TSP& tsp , const std::vector<int>& origin , const std::vector<char>& dirty )
+{
+    int n = tsp.n;
+    int before = dirty.size();
+    int k = std::max(0, std::min(neighbors, n - 1));
+    std::vector<int> nodes(n);
+    std::iota(nodes.begin(), nodes.end(), 0);
+    SpatialGrid grid(tsp); // O(n) buckets, the queries are what costs
+    grid.build(nodes);
+    std::vector<int> near;
+    auto search = [&](int v) {
+        grid.nearestK(v, K, near);
+        std::copy(near.begin(), near.end(), nbr.begin() + (size_t)v * K);
+    };
+
+    if ( k != K || nbr.size() != (size_t)before * K ) { // first revision (or lists of another length)
+        K = k;
+        nbr.assign((size_t)n * K, 0);
+        for ( int v = 0 ; v < n ; ++v ) search(v);
+        return;
+    }
+
+    // kept lists renumbered; a list with a removed or moved hole is searched again
+    std::vector<int> renamed(before, -1);
+    for ( int v = 0 ; v < n ; ++v ) if ( origin[v] >= 0 ) renamed[origin[v]] = v;
+    std::vector<int> old;
+    old.swap(nbr);
+    nbr.assign((size_t)n * K, 0);
+    std::vector<char> again(n, 0);
+    std::vector<int> placed; // moved and new holes
+    for ( int v = 0 ; v < n ; ++v ) {
+        int o = origin[v];
+        if ( o < 0 || dirty[o] ) { placed.push_back(v); continue; }
+        for ( int q = 0 ; q < K ; ++q ) {
+            int u = old[(size_t)o * K + q];
+            if ( dirty[u] ) { again[v] = 1; break; }
+            nbr[(size_t)v * K + q] = renamed[u];
+        }
+    }
+
+    // lists with a removed or moved hole, then the moved and new holes: their own list, and each of them enters
+    // the lists of its 2K nearest holes where it is nearer than their last neighbour
+    for ( int v = 0 ; v < n ; ++v ) if ( again[v] ) search(v);
+    for ( int v : placed ) search(v);
+    auto dist = [&](int a, int b) {
+        return std::fabs(tsp.coord[a][0] - tsp.coord[b][0]) + std::fabs(tsp.coord[a][1] - tsp.coord[b][1]);
+    };
+    for ( int v : placed ) {
+        grid.nearestK(v, 2 * K, near);
+        for ( int u : near ) {
+            int* list = &nbr[(size_t)u * K];
+            if ( std::find(list, list + K, v) != list + K ) continue;
+            double d = dist(u, v);
+            int q = K;
+            while ( q > 0 && ( dist(u, list[q-1]) > d || ( dist(u, list[q-1]) == d && list[q-1] > v ) ) ) --q;
+            if ( q == K ) continue;
+            std::copy_backward(list + q, list + K - 1, list + K);
+            list[q] = v;
+        }
+    }
+}
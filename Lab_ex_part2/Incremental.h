@@ -0,0 +1,64 @@
+/**
+ * @file Incremental.h
+ * @brief TSP re-optimisation of a tour after a board revision (holes added, moved or removed)
+ *
+ */
+
+#pragma once
+
+#include "TSPSolution.h"
+
+/**
+ * Revision of a coordinate instance; holes are given by their original ids (TSP::id)
+ */
+struct BoardDiff
+{
+    std::vector<int> removed;                  // ids of the holes removed
+    std::vector<int> moved;                    // ids of the holes moved ...
+    std::vector<std::vector<double>> movedTo;  // ... and their new positions
+    std::vector<std::vector<double>> added;    // positions of the new holes (ids after the largest one)
+
+    /** read a revision file, one change per line:  remove <id>  |  move <id> <x> <y>  |  add <x> <y>
+     * @return false if the file cannot be read or a line is not valid
+     */
+    bool read ( const char* filename );
+};
+
+/**
+ * Class that updates an instance and a tour of it after a revision, without solving again:
+ *  - the cost matrix is changed only on the rows and columns of the holes involved
+ *    (a removed hole is replaced by the last one, so the other rows keep their place)
+ *  - removed and moved holes leave the tour (their two neighbours are joined), moved and new holes
+ *    enter it by cheapest insertion
+ *  - 2-opt and Or-opt on neighbour lists, only from the holes around the changes (CandidateLocalSearch)
+ * The neighbour lists are kept for the next revision of the same instance: they are renumbered, and only the lists
+ * of the moved and new holes, of the holes whose list had a removed or moved hole, and of the holes near a new
+ * position are searched again (the first revision builds them all)
+ */
+class IncrementalSolver
+{
+public:
+
+    IncrementalSolver ( int neighbors = 8 ) : neighbors(neighbors) , K(0) { }
+
+    /** apply a revision
+     * @param tsp coordinate instance, updated (n, cost, coord, id, infinite)
+     * @param sol tour of the instance before the revision, repaired and improved for the new one
+     * @param diff revision
+     * @return length of the new tour
+     */
+    double apply ( TSP& tsp , TSPSolution& sol , const BoardDiff& diff );
+
+protected:
+    int neighbors;        // neighbour list length of the local search
+    int K;                // length of the kept lists (neighbors, at most n-1)
+    std::vector<int> nbr; // kept lists: neighbours of node v in nbr[v*K] ... nbr[v*K+K-1], nearest first
+
+    /** neighbour lists after a revision: all of them if none are kept, otherwise the kept ones renumbered
+     * @param tsp instance after the revision
+     * @param origin node before the revision of every node (-1: new hole)
+     * @param dirty nodes before the revision whose position changed or that were removed
+     * @return ---
+     */
+    void updateNeighbors ( const TSP& tsp , const std::vector<int>& origin , const std::vector<char>& dirty );
+};
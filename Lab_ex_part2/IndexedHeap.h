@@ -0,0 +1,81 @@
+/**
+ * @file IndexedHeap.h
+ * @brief binary min-heap of nodes with updatable keys
+ *
+ */
+
+#pragma once
+
+#include <vector>
+
+/**
+ * Class that keeps nodes 0 ... n-1 ordered by a key (smallest on top).
+ * The position of every node in the heap is stored, so its key can be changed in O(log n)
+ */
+class IndexedHeap
+{
+public:
+    IndexedHeap ( int n ) : pos(n, -1) , keys(n, 0.0) { heap.reserve(n); }
+
+    bool   empty ( ) const { return heap.empty(); }
+    int    size ( ) const { return heap.size(); }
+    int    top ( ) const { return heap[0]; }
+    bool   contains ( int v ) const { return pos[v] >= 0; }
+    double key ( int v ) const { return keys[v]; }
+
+    void push ( int v , double k ) {
+        keys[v] = k;
+        pos[v] = heap.size();
+        heap.push_back(v);
+        up(pos[v]);
+    }
+
+    /// change the key of a node in the heap (either direction)
+    void update ( int v , double k ) {
+        double old = keys[v];
+        keys[v] = k;
+        if ( k < old ) up(pos[v]);
+        else           down(pos[v]);
+    }
+
+    int pop ( ) {
+        int v = heap[0];
+        place(heap.back(), 0);
+        heap.pop_back();
+        pos[v] = -1;
+        if ( !heap.empty() ) down(0);
+        return v;
+    }
+
+private:
+    std::vector<int>    heap; // nodes, heap ordered by key
+    std::vector<int>    pos;  // position of each node in heap (-1 if not in the heap)
+    std::vector<double> keys;
+
+    // ties broken by the lowest node, so that constructions are deterministic
+    bool less ( int a , int b ) const { return keys[a] < keys[b] || ( keys[a] == keys[b] && a < b ); }
+
+    void place ( int v , int i ) { heap[i] = v; pos[v] = i; }
+
+    void up ( int i ) {
+        int v = heap[i];
+        while ( i > 0 && less(v, heap[(i-1)/2]) ) {
+            place(heap[(i-1)/2], i);
+            i = (i-1)/2;
+        }
+        place(v, i);
+    }
+
+    void down ( int i ) {
+        int v = heap[i];
+        int n = heap.size();
+        while ( 2*i + 1 < n ) {
+            int c = 2*i + 1;
+            if ( c + 1 < n && less(heap[c+1], heap[c]) ) c++;
+            if ( !less(heap[c], v) ) break;
+            place(heap[c], i);
+            i = c;
+        }
+        place(v, i);
+    }
+};
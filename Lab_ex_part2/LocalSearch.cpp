@@ -0,0 +1,37 @@
+/**
+ * @file LocalSearch.cpp
+ * @brief TSP local search (descent to a local optimum)
+ *
+ */
+
+#include "LocalSearch.h"
+
+double LocalSearch::twoOpt ( const TSP& tsp , TSPSolution& sol , double value ) const
+{
+    std::vector<int>& seq = sol.sequence;
+    bool improved = true;
+
+    while (improved)
+    {
+        improved = false;
+        // same neighbourhood as TSPSolver::findBestNeighbor, but the first improving move is applied
+        for ( uint a = 1 ; a < seq.size() - 2 ; a++ ) {
+            int h = seq[a-1];
+            int i = seq[a];
+
+            for ( uint b = a + 1 ; b < seq.size() - 1 ; b++ ) {
+                int j = seq[b];
+                int l = seq[b+1];
+
+                double delta = - tsp.cost[h][i] - tsp.cost[j][l] + tsp.cost[h][j] + tsp.cost[i][l] ;
+                if ( delta < -1e-9 ) {
+                    std::reverse(seq.begin() + a, seq.begin() + b + 1);
+                    value += delta;
+                    improved = true;
+                    i = seq[a]; // node at position a changed with the reversal
+                }
+            }
+        }
+    }
+    return value;
+}
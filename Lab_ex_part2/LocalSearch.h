@@ -0,0 +1,27 @@
+/**
+ * @file LocalSearch.h
+ * @brief TSP local search (descent to a local optimum)
+ *
+ */
+
+#pragma once
+
+#include "TSPSolution.h"
+
+/**
+ * Class that improves a TSP solution by 2-opt moves until no improving move exists
+ */
+class LocalSearch
+{
+public:
+
+    LocalSearch ( ) { }
+
+    /** 2-opt descent (first improvement)
+     * @param tsp TSP instance
+     * @param sol solution to improve (modified in place, initial/final node remains 0)
+     * @param value current value of sol
+     * @return value of the local optimum
+     */
+    double twoOpt ( const TSP& tsp , TSPSolution& sol , double value ) const;
+};
@@ -0,0 +1,333 @@
+/**
+ * @file Memetic.cpp
+ * @brief TSP memetic solver (genetic algorithm + 2-opt local search, island model)
+ *
+ */
+
+#include "Memetic.h"
+#include <thread>
+#include <cmath>
+
+bool MemeticSolver::solve ( const TSP& tsp , const TSPSolution& initSol , int generations , TSPSolution& bestSol )
+{
+    try
+    {
+        if ( tsp.n < 5 ) { // too few free positions to recombine anything
+            bestSol = initSol;
+            ls.twoOpt(tsp, bestSol, solver.evaluate(bestSol, tsp));
+            return true;
+        }
+
+        int nIslands = std::max(1, islands);
+        int gap = ( migrationGap > 0 ) ? migrationGap : generations;
+
+        std::vector<Island> isl;
+        isl.reserve(nIslands);
+        for ( int i = 0 ; i < nIslands ; ++i ) isl.emplace_back(tsp);
+
+        // islands evolve independently for 'gap' generations, then exchange their elite
+        int done = 0;
+        bool first = true;
+        while ( first || done < generations )
+        {
+            int gens = std::min(gap, generations - done);
+            auto run = [&, gens, first] (int i) {
+                if ( first ) initIsland(tsp, isl[i], ( i == 0 ) ? &initSol : NULL, Rng::THREADS + i);
+                evolve(tsp, isl[i], gens);
+            };
+
+            if ( nIslands == 1 ) run(0);
+            else {
+                std::vector<std::thread> threads;
+                for ( int i = 0 ; i < nIslands ; ++i ) threads.emplace_back(run, i);
+                for ( auto& t : threads ) t.join();
+            }
+
+            done += gens;
+            first = false;
+            if ( nIslands > 1 && done < generations ) migrate(isl);
+
+            #if PRINT_ALL_TPSOLVER
+                std::cout << "(" << done << "gen) best value per island";
+                for ( int i = 0 ; i < nIslands ; ++i ) std::cout << " " << *std::min_element(isl[i].value.begin(), isl[i].value.end());
+                std::cout << std::endl;
+            #endif
+        }
+
+        // best individual over all the islands
+        int bi = 0, bj = 0;
+        for ( int i = 0 ; i < nIslands ; ++i ) {
+            for ( int j = 0 ; j < popSize ; ++j ) {
+                if ( isl[i].value[j] < isl[bi].value[bj] ) { bi = i; bj = j; }
+            }
+        }
+        bestSol = isl[bi].pop[bj];
+    }
+    catch(std::exception& e){
+        std::cout << ">>>EXCEPTION: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void MemeticSolver::initIsland ( const TSP& tsp , Island& isl , const TSPSolution* seed , uint64_t stream )
+{
+    int n = tsp.n;
+    isl.rng.seed(Rng::runSeed(), stream);
+
+    isl.pop.reserve(popSize);
+    isl.value.resize(popSize);
+    TourBatch batch;
+    batch.reset(n, popSize);
+    for ( int i = 0 ; i < popSize ; ++i ) {
+        isl.pop.emplace_back(tsp);
+        if ( i == 0 && seed ) isl.pop[i] = *seed;
+        else isl.rng.shuffle(isl.pop[i].sequence.begin() + 1, isl.pop[i].sequence.end() - 1); // 0 stays first and last
+        batch.store(i, isl.pop[i]);
+    }
+    BatchEvaluator(tsp).evaluate(batch, isl.value.data()); // initial population evaluated at once, then the descents
+    for ( int i = 0 ; i < popSize ; ++i ) isl.value[i] = ls.twoOpt(tsp, isl.pop[i], isl.value[i]);
+    isl.children.reset(n, std::max(1, popSize / 2));
+    isl.childValue.resize(isl.children.capacity);
+    for ( int m = 0 ; m < migrants ; ++m ) isl.emigrants.emplace_back(tsp);
+    isl.emigrantValue.resize(migrants);
+
+    isl.used.resize(n);
+    isl.adjA.resize(2*n);
+    isl.adjB.resize(2*n);
+    isl.remA.resize(2*n);
+    isl.remB.resize(2*n);
+    isl.path.reserve(2*n + 1);
+    isl.lastEven.resize(n);
+    isl.label.resize(n);
+    isl.subSize.resize(n);
+}
+
+void MemeticSolver::evolve ( const TSP& tsp , Island& isl , int generations )
+{
+    BatchEvaluator evaluator(tsp);
+    for ( int g = 0 ; g < generations ; ++g ) {
+        // children bred from the current population, evaluated together, then the descents and insertions
+        isl.children.clear();
+        for ( int k = 0 ; k < popSize / 2 ; ++k ) {
+            int a = tournament(isl);
+            int b = tournament(isl);
+            if ( a == b ) b = (a + 1) % popSize;
+
+            if ( isl.rng.uniform() < 0.5 || !crossoverEAX(tsp, isl, isl.pop[a], isl.pop[b], isl.child) ) {
+                crossoverOX(isl, isl.pop[a], isl.pop[b], isl.child);
+            }
+            isl.children.store(k, isl.child);
+        }
+        evaluator.evaluate(isl.children, isl.childValue.data());
+        for ( int k = 0 ; k < isl.children.size ; ++k ) {
+            isl.children.load(k, isl.child);
+            double value = ls.twoOpt(tsp, isl.child, isl.childValue[k]);
+            insert(isl, isl.child, value);
+        }
+    }
+}
+
+void MemeticSolver::migrate ( std::vector<Island>& isl )
+{
+    // first collect the elite of every island, then send it to the next island of the ring
+    std::vector<int> order(popSize);
+    int nm = std::min(migrants, popSize);
+    for ( auto& from : isl ) {
+        std::iota(order.begin(), order.end(), 0);
+        std::partial_sort(order.begin(), order.begin() + nm, order.end(),
+                          [&](int a, int b){ return from.value[a] < from.value[b]; });
+        for ( int m = 0 ; m < nm ; ++m ) {
+            from.emigrants[m] = from.pop[order[m]];
+            from.emigrantValue[m] = from.value[order[m]];
+        }
+    }
+    for ( uint i = 0 ; i < isl.size() ; ++i ) {
+        Island& to = isl[(i + 1) % isl.size()];
+        for ( int m = 0 ; m < nm ; ++m ) insert(to, isl[i].emigrants[m], isl[i].emigrantValue[m]);
+    }
+}
+
+int MemeticSolver::tournament ( Island& isl )
+{
+    int a = isl.rng.below(popSize);
+    int b = isl.rng.below(popSize);
+    return ( isl.value[a] <= isl.value[b] ) ? a : b;
+}
+
+int MemeticSolver::worst ( const Island& isl ) const
+{
+    int w = 0;
+    for ( int i = 1 ; i < popSize ; ++i ) {
+        if ( isl.value[i] > isl.value[w] ) w = i;
+    }
+    return w;
+}
+
+bool MemeticSolver::insert ( Island& isl , const TSPSolution& sol , double value )
+{
+    int w = worst(isl);
+    if ( value >= isl.value[w] - 0.01 ) return false;
+    for ( int i = 0 ; i < popSize ; ++i ) {
+        if ( std::fabs(isl.value[i] - value) < 0.01 ) return false; // (probably) already in the population
+    }
+    isl.pop[w] = sol;
+    isl.value[w] = value;
+    return true;
+}
+
+void MemeticSolver::crossoverOX ( Island& isl , const TSPSolution& pa , const TSPSolution& pb , TSPSolution& child )
+{
+    // free positions are 1 ... n-1 (initial/final node remains 0)
+    int free = pa.sequence.size() - 2;
+    int i = 1 + isl.rng.below(free);
+    int j = 1 + isl.rng.below(free);
+    if ( i > j ) std::swap(i, j);
+
+    std::fill(isl.used.begin(), isl.used.end(), 0);
+    for ( int k = i ; k <= j ; ++k ) {
+        child.sequence[k] = pa.sequence[k];
+        isl.used[pa.sequence[k]] = 1;
+    }
+    // fill from position j+1 (circularly on the free positions) following pb from position j+1
+    int dst = j % free + 1;
+    for ( int t = 0 ; t < free ; ++t ) {
+        int node = pb.sequence[(j + t) % free + 1];
+        if ( !isl.used[node] ) {
+            child.sequence[dst] = node;
+            dst = dst % free + 1;
+        }
+    }
+    child.sequence.front() = child.sequence.back() = 0;
+}
+
+bool MemeticSolver::crossoverEAX ( const TSP& tsp , Island& isl , const TSPSolution& pa , const TSPSolution& pb , TSPSolution& child )
+{
+    int n = tsp.n;
+    std::vector<int>& adj  = isl.adjA;
+    std::vector<int>& remA = isl.remA;
+    std::vector<int>& remB = isl.remB;
+    std::vector<int>& path = isl.path;
+
+    buildAdjacency(pa, adj);
+    buildAdjacency(pb, isl.adjB);
+    remA = adj;
+    remB = isl.adjB;
+
+    // edges shared by A and B can't be part of an AB-cycle
+    for ( int u = 0 ; u < n ; ++u ) {
+        for ( int s = 0 ; s < 2 ; ++s ) {
+            int v = adj[2*u+s];
+            if ( remB[2*u] == v )   { remA[2*u+s] = -1; remB[2*u] = -1; }
+            if ( remB[2*u+1] == v ) { remA[2*u+s] = -1; remB[2*u+1] = -1; }
+        }
+    }
+
+    // start the walk from a random node with a free A edge
+    int start = -1;
+    for ( int k = 0 , r = isl.rng.below(n) ; k < n ; ++k ) {
+        int u = (r + k) % n;
+        if ( remA[2*u] >= 0 || remA[2*u+1] >= 0 ) { start = u; break; }
+    }
+    if ( start < 0 ) return false; // same tour
+
+    // alternating walk (A edge, B edge, ...) until a node is met again at an even position:
+    // the closed part of the walk is an AB-cycle (starts with an A edge, ends with a B edge)
+    auto takeEdge = [&](std::vector<int>& rem, int u) {
+        int s;
+        if ( rem[2*u] >= 0 && rem[2*u+1] >= 0 ) s = isl.rng() & 1;
+        else s = ( rem[2*u] >= 0 ) ? 0 : 1;
+        int v = rem[2*u+s];
+        if ( v < 0 ) return -1;
+        rem[2*u+s] = -1;
+        if ( rem[2*v] == u ) rem[2*v] = -1;
+        else                 rem[2*v+1] = -1;
+        return v;
+    };
+
+    std::fill(isl.lastEven.begin(), isl.lastEven.end(), -1);
+    path.clear();
+    path.push_back(start);
+    isl.lastEven[start] = 0;
+    int cycleStart = -1;
+    int cur = start;
+    while ( cycleStart < 0 ) {
+        cur = takeEdge(remA, cur);
+        if ( cur < 0 ) return false;
+        path.push_back(cur);
+        cur = takeEdge(remB, cur);
+        if ( cur < 0 ) return false;
+        path.push_back(cur);
+        if ( isl.lastEven[cur] >= 0 ) cycleStart = isl.lastEven[cur];
+        else isl.lastEven[cur] = path.size() - 1;
+    }
+
+    // intermediate solution: A without the A edges of the cycle, plus its B edges
+    for ( uint k = cycleStart ; k + 1 < path.size() ; k += 2 ) {
+        int u = path[k], v = path[k+1];
+        replaceAdjacent(adj, u, v, -1);
+        replaceAdjacent(adj, v, u, -1);
+    }
+    for ( uint k = cycleStart + 1 ; k + 1 < path.size() ; k += 2 ) {
+        int u = path[k], v = path[k+1];
+        replaceAdjacent(adj, u, -1, v);
+        replaceAdjacent(adj, v, -1, u);
+    }
+
+    // label the subtours of the intermediate solution
+    std::fill(isl.label.begin(), isl.label.end(), -1);
+    int nSub = 0;
+    for ( int s = 0 ; s < n ; ++s ) {
+        if ( isl.label[s] >= 0 ) continue;
+        int prev = adj[2*s], node = s, size = 0;
+        do {
+            isl.label[node] = nSub;
+            ++size;
+            int next = ( adj[2*node] == prev ) ? adj[2*node+1] : adj[2*node];
+            prev = node;
+            node = next;
+        } while ( node != s );
+        isl.subSize[nSub++] = size;
+    }
+
+    // merge the smallest subtour with the closest one by the best 2-exchange
+    for ( int left = nSub ; left > 1 ; --left ) {
+        int small = -1;
+        for ( int t = 0 ; t < nSub ; ++t ) {
+            if ( isl.subSize[t] > 0 && ( small < 0 || isl.subSize[t] < isl.subSize[small] ) ) small = t;
+        }
+
+        double bestDelta = tsp.infinite;
+        int bu = -1, bu2 = -1, bw = -1, bw2 = -1;
+        for ( int u = 0 ; u < n ; ++u ) {
+            if ( isl.label[u] != small ) continue;
+            for ( int su = 0 ; su < 2 ; ++su ) {
+                int u2 = adj[2*u+su];
+                for ( int w = 0 ; w < n ; ++w ) {
+                    if ( isl.label[w] == small ) continue;
+                    for ( int sw = 0 ; sw < 2 ; ++sw ) {
+                        int w2 = adj[2*w+sw];
+                        double delta = tsp.cost[u][w] + tsp.cost[u2][w2] - tsp.cost[u][u2] - tsp.cost[w][w2];
+                        if ( delta < bestDelta ) { bestDelta = delta; bu = u; bu2 = u2; bw = w; bw2 = w2; }
+                    }
+                }
+            }
+        }
+
+        // remove (u,u2) and (w,w2), add (u,w) and (u2,w2)
+        replaceAdjacent(adj, bu,  bu2, bw);
+        replaceAdjacent(adj, bu2, bu,  bw2);
+        replaceAdjacent(adj, bw,  bw2, bu);
+        replaceAdjacent(adj, bw2, bw,  bu2);
+
+        int into = isl.label[bw];
+        for ( int u = 0 ; u < n ; ++u ) {
+            if ( isl.label[u] == small ) isl.label[u] = into;
+        }
+        isl.subSize[into] += isl.subSize[small];
+        isl.subSize[small] = 0;
+    }
+
+    child.fromAdjacency(adj);
+    return true;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file Memetic.h
+ * @brief TSP memetic solver (genetic algorithm + 2-opt local search, island model)
+ *
+ */
+
+#pragma once
+
+#include "TSPSolver.h"
+#include "LocalSearch.h"
+#include "BatchEvaluator.h"
+
+/**
+ * Class that solves a TSP problem with a population of 2-opt local optima,
+ * recombined by order crossover (OX) and edge assembly crossover (EAX).
+ * The population is split in islands (one per thread) that exchange their elite solutions
+ * every 'migrationGap' generations (ring topology). The popSize/2 children of a generation are bred from the
+ * population of the previous one and evaluated together before their descents
+ */
+class MemeticSolver
+{
+public:
+
+    MemeticSolver ( int popSize = 20 , int islands = 1 , int migrationGap = 10 , int migrants = 2 )
+        : popSize(popSize) , islands(islands) , migrationGap(migrationGap) , migrants(migrants) { }
+
+    /** solve
+     * @param tsp TSP instance
+     * @param initSol initial solution (inserted in the population of the first island)
+     * @param generations number of generations of every island
+     * @param bestSol best solution found
+     * @return true if no exception
+     */
+    bool solve ( const TSP& tsp , const TSPSolution& initSol , int generations , TSPSolution& bestSol );
+
+protected:
+    int popSize;        // individuals per island
+    int islands;        // number of islands (threads)
+    int migrationGap;   // generations between two migrations
+    int migrants;       // elite individuals sent to the next island at each migration
+
+    TSPSolver   solver; // evaluate()
+    LocalSearch ls;
+
+    /// everything an island needs during evolution, allocated once before the first generation
+    struct Island {
+        std::vector<TSPSolution> pop;
+        std::vector<double>      value;
+        std::vector<TSPSolution> emigrants;
+        std::vector<double>      emigrantValue;
+        TSPSolution              child;
+        TourBatch                children;   // the children of a generation
+        std::vector<double>      childValue;
+        Rng                      rng;
+
+        // crossover buffers
+        std::vector<char> used;     // OX: node already in the child
+        std::vector<int>  adjA;     // EAX: tour adjacency of parent A (2 slots per node), then of the child
+        std::vector<int>  adjB;     // EAX: tour adjacency of parent B
+        std::vector<int>  remA;     // EAX: A edges not yet in an AB-cycle (-1 = used or common)
+        std::vector<int>  remB;     // EAX: B edges not yet in an AB-cycle
+        std::vector<int>  path;     // EAX: alternating walk
+        std::vector<int>  lastEven; // EAX: last even position of a node in the walk
+        std::vector<int>  label;    // EAX: subtour of each node
+        std::vector<int>  subSize;  // EAX: size of each subtour
+
+        Island ( const TSP& tsp ) : child(tsp) { }
+    };
+
+    void initIsland ( const TSP& tsp , Island& isl , const TSPSolution* seed , uint64_t stream );
+    void evolve ( const TSP& tsp , Island& isl , int generations );
+    void migrate ( std::vector<Island>& isl );
+
+    int  tournament ( Island& isl );
+    int  worst ( const Island& isl ) const;
+    bool insert ( Island& isl , const TSPSolution& sol , double value );
+
+    /// order crossover: a random segment of pa, the remaining nodes in the order of pb
+    void crossoverOX ( Island& isl , const TSPSolution& pa , const TSPSolution& pb , TSPSolution& child );
+    /// edge assembly crossover (single AB-cycle): returns false if the parents have the same edges
+    bool crossoverEAX ( const TSP& tsp , Island& isl , const TSPSolution& pa , const TSPSolution& pb , TSPSolution& child );
+
+    void buildAdjacency ( const TSPSolution& sol , std::vector<int>& adj ) const {
+        int n = sol.sequence.size() - 1;
+        for ( int k = 0 ; k < n ; ++k ) {
+            int node = sol.sequence[k];
+            adj[2*node]   = sol.sequence[k == 0 ? n-1 : k-1];
+            adj[2*node+1] = sol.sequence[k+1];
+        }
+    }
+
+    static void replaceAdjacent ( std::vector<int>& adj , int node , int oldNode , int newNode ) {
+        if ( adj[2*node] == oldNode ) adj[2*node] = newNode;
+        else                          adj[2*node+1] = newNode;
+    }
+};
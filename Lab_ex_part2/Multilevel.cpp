@@ -0,0 +1,182 @@
+/**
+ * @file Multilevel.cpp
+ * @brief TSP multilevel solver for large coordinate instances (coarsening by matching, tabu search, refinement)
+ *
+ */
+
+#include "Multilevel.h"
+#include "FixedTSPSolver.h"
+#include "SpatialGrid.h"
+
+double MultilevelSolver::solve ( const TSP& tsp , int tabulength , int maxIter , TSPSolution& bestSol )
+{
+    int n = tsp.n;
+    auto dist = [&](int a, int b) {
+        return std::fabs(tsp.coord[a][0] - tsp.coord[b][0]) + std::fabs(tsp.coord[a][1] - tsp.coord[b][1]);
+    };
+
+    // flat arrays for all the levels: every level has at most half the paths of the previous one, plus one
+    size_t cap = 2 * (size_t)n + 64;
+    head.resize(cap);   tail.resize(cap);
+    childA.resize(cap); childB.resize(cap);
+    flipA.resize(cap);  flipB.resize(cap);
+    link.assign(2*n, -1);
+    linkLevel.assign(2*n, 0);
+    fixed.resize(2*n);
+    std::vector<char> matched(cap, 0);
+    std::vector<int>  owner(n, -1); // path of every end hole on the level being matched
+    std::vector<int>  ends;
+    ends.reserve(n);
+
+    // level 0: one path per hole
+    levelStart.assign(1, 0);
+    for ( int v = 0 ; v < n ; ++v ) {
+        head[v] = tail[v] = v;
+        childA[v] = childB[v] = -1;
+    }
+    levelStart.push_back(n);
+    int count = n;
+    std::vector<int> curve = tsp.hilbertOrder(); // order of the matching on level 0
+
+    // coarsening
+    while ( levelStart[levels()] - levelStart[levels()-1] > std::max(coarsest, 3) ) {
+        int l = levels() - 1;
+        int begin = levelStart[l], end = levelStart[l+1];
+        ends.clear();
+        for ( int p = begin ; p < end ; ++p ) {
+            owner[head[p]] = owner[tail[p]] = p;
+            ends.push_back(head[p]);
+            if ( tail[p] != head[p] ) ends.push_back(tail[p]);
+        }
+        SpatialGrid grid(tsp);
+        grid.build(ends);
+
+        for ( int i = begin ; i < end ; ++i ) {
+            int p = ( l == 0 ) ? curve[i] : i; // along the curve: the next levels inherit the order
+            if ( matched[p] ) continue;
+            matched[p] = 1;
+            grid.remove(head[p]);
+            if ( tail[p] != head[p] ) grid.remove(tail[p]);
+
+            int r = count++;
+            childA[r] = p;
+            flipA[r] = flipB[r] = 0;
+            if ( grid.nodes() == 0 ) { // the last path: copied to the next level
+                childB[r] = -1;
+                head[r] = head[p];
+                tail[r] = tail[p];
+                continue;
+            }
+
+            // nearest end of another path from either end of p
+            int u = head[p];
+            int v = grid.nearest(tsp.coord[u][0], tsp.coord[u][1]);
+            if ( tail[p] != head[p] ) {
+                int w = grid.nearest(tsp.coord[tail[p]][0], tsp.coord[tail[p]][1]);
+                if ( dist(tail[p], w) < dist(u, v) ) { u = tail[p]; v = w; }
+            }
+            int q = owner[v];
+            matched[q] = 1;
+            if ( v == head[q] ) { if ( tail[q] != head[q] ) grid.remove(tail[q]); }
+            else grid.remove(head[q]);
+            grid.remove(v);
+
+            // r = p ending at u, then q starting from v
+            childB[r] = q;
+            flipA[r] = ( u == head[p] && tail[p] != head[p] );
+            flipB[r] = ( v == tail[q] && tail[q] != head[q] );
+            head[r] = flipA[r] ? tail[p] : head[p];
+            tail[r] = flipB[r] ? head[q] : tail[q];
+            int su = 2*u + (link[2*u] >= 0), sv = 2*v + (link[2*v] >= 0);
+            link[su] = v;
+            link[sv] = u;
+            linkLevel[su] = linkLevel[sv] = l + 1;
+        }
+        levelStart.push_back(count);
+    }
+    int top = levels() - 1;
+
+    // coarsest level: tour on the path ends, the two ends of a path joined at cost 0, the other edges cost + M
+    int begin = levelStart[top], end = levelStart[top+1];
+    ends.clear();
+    for ( int p = begin ; p < end ; ++p ) {
+        owner[head[p]] = owner[tail[p]] = p;
+        ends.push_back(head[p]);
+        if ( tail[p] != head[p] ) ends.push_back(tail[p]);
+    }
+    int S = ends.size();
+    TSP sub;
+    sub.n = S;
+    sub.cost.assign(S, std::vector<double>(S, 0.0));
+    double span = 0.0;
+    for ( int i = 0 ; i < S ; ++i ) {
+        for ( int j = 0 ; j < S ; ++j ) span = std::max(span, dist(ends[i], ends[j]));
+    }
+    double M = ( S + 1 ) * span + 1; // a tour that drops a path costs more than any tour that keeps them
+    for ( int i = 0 ; i < S ; ++i ) {
+        for ( int j = 0 ; j < S ; ++j ) {
+            if ( i != j ) sub.cost[i][j] = ( owner[ends[i]] == owner[ends[j]] ) ? 0.0 : dist(ends[i], ends[j]) + M;
+        }
+    }
+    sub.id.resize(S);
+    std::iota(sub.id.begin(), sub.id.end(), 0);
+    sub.setInfinite();
+    TSPSolution init(sub), best(sub); // the ends in path order: every path kept
+    if ( S >= 5 && !solveFixed(sub, init, tabulength, maxIter, best) ) {
+        TSPSolver solver;
+        solver.solve(sub, init, tabulength, maxIter, best);
+    }
+
+    // holes in the order of the coarsest tour (a path may be split by the start of the sequence)
+    std::vector<int> order;
+    order.reserve(n);
+    int k = 0;
+    int first = owner[ends[best.sequence[0]]];
+    if ( S > 1 && head[first] != tail[first] && owner[ends[best.sequence[1]]] != first ) k = 1;
+    for ( int done = 0 ; done < S ; ) {
+        int e = ends[best.sequence[k % S]];
+        int p = owner[e];
+        bool flip = ( e == tail[p] && tail[p] != head[p] );
+        expand(p, flip, order);
+        int step = ( tail[p] != head[p] ) ? 2 : 1;
+        k += step;
+        done += step;
+    }
+
+    // uncoarsening: refinement of every level with its joining edges fixed, from the path ends
+    CandidateLocalSearch ls(tsp, neighbors);
+    ls.buildNeighbors(threads);
+    ls.fixed = &fixed;
+    for ( int l = top ; l >= 0 ; --l ) {
+        for ( int s = 0 ; s < 2*n ; ++s ) fixed[s] = ( link[s] >= 0 && linkLevel[s] <= l ) ? link[s] : -1;
+        ends.clear();
+        for ( int p = levelStart[l] ; p < levelStart[l+1] ; ++p ) {
+            ends.push_back(head[p]);
+            if ( tail[p] != head[p] ) ends.push_back(tail[p]);
+        }
+        ls.improve(order, ends);
+    }
+
+    #if PRINT_ALL_TPSOLVER
+        std::cout << "multilevel: " << levels() << " levels, " << S << " ends on the coarsest" << std::endl;
+    #endif
+
+    std::rotate(order.begin(), std::find(order.begin(), order.end(), 0), order.end());
+    std::copy(order.begin(), order.end(), bestSol.sequence.begin());
+    bestSol.sequence[n] = 0;
+    return ls.length(bestSol);
+}
+
+void MultilevelSolver::expand ( int p , bool flip , std::vector<int>& order ) const
+{
+    if ( childA[p] < 0 ) { order.push_back(p); return; } // a hole
+    if ( childB[p] < 0 ) { expand(childA[p], flip != (bool)flipA[p], order); return; }
+    if ( !flip ) {
+        expand(childA[p], flipA[p], order);
+        expand(childB[p], flipB[p], order);
+    }
+    else {
+        expand(childB[p], !flipB[p], order);
+        expand(childA[p], !flipA[p], order);
+    }
+}
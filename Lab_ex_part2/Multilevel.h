@@ -0,0 +1,56 @@
+/**
+ * @file Multilevel.h
+ * @brief TSP multilevel solver for large coordinate instances (coarsening by matching, tabu search, refinement)
+ *
+ */
+
+#pragma once
+
+#include "TSPSolver.h"
+#include "CandidateLocalSearch.h"
+
+/**
+ * Class that solves a large coordinate instance by the multilevel scheme (Walshaw):
+ *  - coarsening: every level matches each path with the nearest unmatched path (closest ends) and joins them by
+ *    that edge, which stays fixed on the coarser levels; level 0 has one path per hole
+ *  - the coarsest level (at most 'coarsest' paths) is a TSP on the path ends, solved by tabu search: the two
+ *    ends of a path are joined at cost 0 and every other edge costs a constant more, so the tours keep the paths
+ *  - uncoarsening: the tour is refined on every level, from the coarsest, by 2-opt and Or-opt moves that keep
+ *    the fixed edges of the level (CandidateLocalSearch), starting from the path ends
+ * All the levels are stored in flat arrays allocated once (at most 2n paths over all the levels)
+ */
+class MultilevelSolver
+{
+public:
+
+    MultilevelSolver ( int coarsest = 50 , int neighbors = 8 , int threads = 1 )
+        : coarsest(coarsest) , neighbors(neighbors) , threads(threads) { }
+
+    /** solve
+     * @param tsp TSP instance (positions, the cost matrix is not used)
+     * @param tabulength tabu length of the coarsest search
+     * @param maxIter iterations of the coarsest search
+     * @param bestSol solution found
+     * @return its length
+     */
+    double solve ( const TSP& tsp , int tabulength , int maxIter , TSPSolution& bestSol );
+
+    int levels ( ) const { return levelStart.size() - 1; } // levels built by the last solve
+
+protected:
+    int coarsest;  // paths on the coarsest level (at most)
+    int neighbors; // neighbour list length of the refinement
+    int threads;
+
+    // paths of all the levels: level l is paths levelStart[l] ... levelStart[l+1]-1
+    std::vector<int>  levelStart;
+    std::vector<int>  head, tail;     // end holes of every path (the same hole for a single hole)
+    std::vector<int>  childA, childB; // finer paths joined (childB -1: path copied unmatched)
+    std::vector<char> flipA, flipB;   // children traversed from tail to head
+    std::vector<int>  link;           // joining edges of every hole: link[2v], link[2v+1] (-1 none)
+    std::vector<int>  linkLevel;      // level of the first path that contains the joining edge
+    std::vector<int>  fixed;          // joining edges fixed on the level being refined
+
+    /// the holes of path p (reversed if flip) appended to order
+    void expand ( int p , bool flip , std::vector<int>& order ) const;
+};
@@ -0,0 +1,154 @@
+/**
+ * @file OneTree.h
+ * @brief minimum 1-trees and the Held-Karp lower bound (subgradient optimisation)
+ *
+ */
+
+#pragma once
+
+#include <cmath>
+#include "TSP.h"
+
+/**
+ * Class that computes minimum 1-trees: a spanning tree on the nodes 1 ... n-1 plus the two cheapest edges of node 0.
+ * Every tour is a 1-tree, so with node penalties pi the minimum 1-tree on the costs c(i,j) + pi(i) + pi(j), minus
+ * 2 sum(pi), is a lower bound on the optimal tour (Held & Karp). The penalties are improved by subgradient
+ * steps pi(i) += t (degree(i) - 2), that push the 1-tree towards a tour.
+ * Edges can be forced in or out of the 1-trees (branch and bound): state[i*n+j] = 1 (in), -1 (out), 0 (free)
+ */
+class OneTree
+{
+public:
+    OneTree ( const TSP& tsp ) : tsp(tsp) , n(tsp.n) , degree(n) , parent(n) , order(n > 1 ? n - 1 : 0) , key(n) , done(n) { }
+
+    const TSP& tsp;
+    int n;
+    std::vector<int> degree;    // degree of every node in the last 1-tree
+    std::vector<int> parent;    // tree edges (v, parent[v]) for v in 2 ... n-1 (node 1 is the root)
+    std::vector<int> order;     // nodes 1 ... n-1 in the order they joined the tree (a parent before its children)
+    int zeroA, zeroB;           // the two neighbours of node 0
+
+private:
+    std::vector<double> key;    // Prim buffers
+    std::vector<char>   done;
+
+public:
+
+    /** minimum 1-tree with penalties
+     * @param pi node penalties
+     * @param state edge states (NULL: all free)
+     * @return bound w(pi) = 1-tree length on the penalised costs - 2 sum(pi), tsp.infinite if no 1-tree respects the states
+     */
+    double build ( const std::vector<double>& pi , const std::vector<signed char>* state = NULL )
+    {
+        const double FORCED = tsp.infinite; // forced edges are taken first (they are a forest, see BranchBound)
+        auto weight = [&](int u, int v) {
+            double w = tsp.cost[u][v] + pi[u] + pi[v];
+            if ( state ) {
+                signed char s = (*state)[u*n+v];
+                if ( s < 0 ) return HUGE_VAL;
+                if ( s > 0 ) w -= FORCED;
+            }
+            return w;
+        };
+
+        std::fill(degree.begin(), degree.end(), 0);
+        double total = 0.0;
+
+        // Prim on the nodes 1 ... n-1, O(n^2)
+        std::fill(done.begin(), done.end(), 0);
+        std::fill(key.begin(), key.end(), HUGE_VAL);
+        parent[1] = -1;
+        int u = 1;
+        done[1] = 1;
+        order[0] = 1;
+        for ( int step = 2 ; step < n ; ++step ) {
+            int next = -1;
+            for ( int v = 2 ; v < n ; ++v ) {
+                if ( done[v] ) continue;
+                double w = weight(u, v);
+                if ( w < key[v] ) { key[v] = w; parent[v] = u; }
+                if ( next < 0 || key[v] < key[next] ) next = v;
+            }
+            if ( key[next] == HUGE_VAL ) return tsp.infinite;
+            done[next] = 1;
+            order[step-1] = next;
+            total += tsp.cost[next][parent[next]] + pi[next] + pi[parent[next]];
+            degree[next]++;
+            degree[parent[next]]++;
+            u = next;
+        }
+
+        // node 0: its two cheapest edges
+        zeroA = zeroB = -1;
+        for ( int v = 1 ; v < n ; ++v ) {
+            double w = weight(0, v);
+            if ( w == HUGE_VAL ) continue;
+            if ( zeroA < 0 || w < weight(0, zeroA) ) { zeroB = zeroA; zeroA = v; }
+            else if ( zeroB < 0 || w < weight(0, zeroB) ) zeroB = v;
+        }
+        if ( zeroB < 0 ) return tsp.infinite;
+        total += tsp.cost[0][zeroA] + pi[0] + pi[zeroA] + tsp.cost[0][zeroB] + pi[0] + pi[zeroB];
+        degree[0] = 2;
+        degree[zeroA]++;
+        degree[zeroB]++;
+
+        for ( int v = 0 ; v < n ; ++v ) total -= 2 * pi[v];
+        return total;
+    }
+
+    /// the last 1-tree is a tour (every degree is 2)
+    bool isTour ( ) const {
+        for ( int v = 0 ; v < n ; ++v ) if ( degree[v] != 2 ) return false;
+        return true;
+    }
+
+    /** subgradient optimisation of the penalties (Held-Karp step t = lambda (upper - w) / |degree - 2|^2)
+     * @param pi initial penalties (warm start), the best ones found on return (the last 1-tree is built on them)
+     * @param upper upper bound (incumbent value): the ascent stops when the bound reaches it
+     * @param iterations maximum number of 1-trees
+     * @param lambda initial step factor (halved after 'period' iterations without improvement)
+     * @param state edge states (NULL: all free)
+     * @return best bound found, tsp.infinite if infeasible
+     */
+    double ascent ( std::vector<double>& pi , double upper , int iterations , double lambda = 2.0 ,
+                    const std::vector<signed char>* state = NULL )
+    {
+        std::vector<double> bestPi(pi);
+        double best = -tsp.infinite;
+        int period = std::max(5, n / 4), still = 0;
+
+        for ( int it = 0 ; it < iterations && lambda > 1e-5 ; ++it ) {
+            double w = build(pi, state);
+            if ( w >= tsp.infinite ) return tsp.infinite;
+            if ( w > best + 1e-9 ) { best = w; bestPi = pi; still = 0; }
+            else if ( ++still >= period ) { lambda /= 2; still = 0; }
+            if ( best >= upper - 1e-9 ) break;
+
+            double norm = 0.0;
+            for ( int v = 0 ; v < n ; ++v ) norm += (degree[v] - 2) * (degree[v] - 2);
+            if ( norm == 0 ) break; // the 1-tree is a tour: optimal for these states
+            double t = lambda * (upper - w) / norm;
+            for ( int v = 0 ; v < n ; ++v ) pi[v] += t * (degree[v] - 2);
+        }
+        pi = bestPi;
+        build(pi, state);
+        return best;
+    }
+
+    /** Held-Karp lower bound on the optimal tour (ascent from zero penalties), rounded up if the costs are integers
+     * @param upper value of a known tour (step size, stop)
+     * @param iterations maximum number of 1-trees
+     * @return lower bound
+     */
+    double lowerBound ( double upper , int iterations )
+    {
+        if ( n < 4 ) return -tsp.infinite;
+        std::vector<double> pi(n, 0.0);
+        double bound = ascent(pi, upper, iterations);
+        for ( int i = 0 ; i < n ; ++i ) {
+            for ( int j = 0 ; j < n ; ++j ) if ( tsp.cost[i][j] != std::floor(tsp.cost[i][j]) ) return bound;
+        }
+        return std::ceil(bound - 1e-6);
+    }
+};
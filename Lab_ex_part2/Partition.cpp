@@ -0,0 +1,191 @@
+/**
+ * @file Partition.cpp
+ * @brief TSP partition solver for very large coordinate instances (k-d cells, sub-paths merged, global local search)
+ *
+ */
+
+#include "Partition.h"
+#include "FixedTSPSolver.h"
+#include <atomic>
+#include <thread>
+
+double PartitionSolver::solve ( const TSP& tsp , int tabulength , int maxIter , TSPSolution& bestSol )
+{
+    int n = tsp.n;
+    auto dist = [&](int a, int b) {
+        return std::fabs(tsp.coord[a][0] - tsp.coord[b][0]) + std::fabs(tsp.coord[a][1] - tsp.coord[b][1]);
+    };
+
+    // k-d cells
+    nodes.resize(n);
+    std::iota(nodes.begin(), nodes.end(), 0);
+    cellStart.assign(1, 0);
+    split(tsp, 0, n);
+    int C = cellStart.size() - 1;
+
+    // cell order: Hilbert curve through the cell centres
+    TSP centres;
+    centres.n = C;
+    centres.coord.assign(C, std::vector<double>(2, 0.0));
+    for ( int c = 0 ; c < C ; ++c ) {
+        for ( int k = cellStart[c] ; k < cellStart[c+1] ; ++k ) {
+            centres.coord[c][0] += tsp.coord[nodes[k]][0];
+            centres.coord[c][1] += tsp.coord[nodes[k]][1];
+        }
+        centres.coord[c][0] /= cellStart[c+1] - cellStart[c];
+        centres.coord[c][1] /= cellStart[c+1] - cellStart[c];
+    }
+    std::vector<int> cellOrder = centres.hilbertOrder();
+    std::vector<int> sorted;
+    std::vector<int> sortedStart(1, 0);
+    sorted.reserve(n);
+    for ( int c : cellOrder ) {
+        sorted.insert(sorted.end(), nodes.begin() + cellStart[c], nodes.begin() + cellStart[c+1]);
+        sortedStart.push_back(sorted.size());
+    }
+    nodes.swap(sorted);
+    cellStart.swap(sortedStart);
+
+    // entries and exits: closest pair of holes of two consecutive cells
+    // (a path of two or more holes has different ends)
+    entry.assign(C, -1);
+    exit.assign(C, -1);
+    auto size = [&](int c) { return cellStart[c+1] - cellStart[c]; };
+    for ( int c = 0 ; C > 1 && c < C ; ++c ) {
+        int next = ( c + 1 ) % C;
+        double best = HUGE_VAL;
+        for ( int a = cellStart[c] ; a < cellStart[c+1] ; ++a ) {
+            int u = nodes[a];
+            if ( u == entry[c] && size(c) > 1 ) continue;
+            for ( int b = cellStart[next] ; b < cellStart[next+1] ; ++b ) {
+                int v = nodes[b];
+                if ( v == exit[next] && size(next) > 1 ) continue;
+                double d = dist(u, v);
+                if ( d < best ) { best = d; exit[c] = u; entry[next] = v; }
+            }
+        }
+    }
+
+    // paths of the cells, in parallel
+    int nThreads = std::max(1, std::min(threads, C));
+    std::atomic<int> nextCell(0);
+    auto run = [&] () {
+        TSPSolver solver;
+        for ( int c = nextCell++ ; c < C ; c = nextCell++ ) solveCell(tsp, c, solver, tabulength, maxIter);
+    };
+    if ( nThreads == 1 ) run();
+    else {
+        std::vector<std::thread> pool;
+        for ( int t = 0 ; t < nThreads ; ++t ) pool.emplace_back(run);
+        for ( auto& th : pool ) th.join();
+    }
+
+    #if PRINT_ALL_TPSOLVER
+        std::cout << "partition: " << C << " cells" << std::endl;
+    #endif
+
+    // merged tour, then the global local search
+    CandidateLocalSearch ls(tsp, neighbors);
+    ls.buildNeighbors(threads);
+    ls.improve(nodes, std::vector<int>());
+    std::rotate(nodes.begin(), std::find(nodes.begin(), nodes.end(), 0), nodes.end());
+    std::copy(nodes.begin(), nodes.end(), bestSol.sequence.begin());
+    bestSol.sequence[n] = 0;
+    return ls.length(bestSol);
+}
+
+void PartitionSolver::split ( const TSP& tsp , int begin , int end )
+{
+    if ( end - begin <= cellSize ) {
+        cellStart.push_back(end);
+        return;
+    }
+    double x0 = HUGE_VAL, x1 = -HUGE_VAL, y0 = HUGE_VAL, y1 = -HUGE_VAL;
+    for ( int k = begin ; k < end ; ++k ) {
+        const std::vector<double>& p = tsp.coord[nodes[k]];
+        x0 = std::min(x0, p[0]);  x1 = std::max(x1, p[0]);
+        y0 = std::min(y0, p[1]);  y1 = std::max(y1, p[1]);
+    }
+    int dim = ( x1 - x0 >= y1 - y0 ) ? 0 : 1;
+    int mid = begin + ( end - begin ) / 2;
+    std::nth_element(nodes.begin() + begin, nodes.begin() + mid, nodes.begin() + end, [&](int a, int b) {
+        return tsp.coord[a][dim] < tsp.coord[b][dim] || ( tsp.coord[a][dim] == tsp.coord[b][dim] && a < b ); });
+    split(tsp, begin, mid);
+    split(tsp, mid, end);
+}
+
+void PartitionSolver::solveCell ( const TSP& tsp , int c , TSPSolver& solver , int tabulength , int maxIter )
+{
+    int* cell = &nodes[cellStart[c]];
+    int m = cellStart[c+1] - cellStart[c];
+    bool closed = ( entry[c] < 0 ); // a single cell: a tour instead of a path
+    auto dist = [&](int a, int b) {
+        return std::fabs(tsp.coord[a][0] - tsp.coord[b][0]) + std::fabs(tsp.coord[a][1] - tsp.coord[b][1]);
+    };
+
+    if ( closed && m <= 3 ) return; // any order is the tour
+    if ( !closed && m <= 3 ) { // entry, the middle hole, exit
+        std::vector<int> path;
+        path.push_back(entry[c]);
+        for ( int k = 0 ; k < m ; ++k ) if ( cell[k] != entry[c] && cell[k] != exit[c] ) path.push_back(cell[k]);
+        if ( exit[c] != entry[c] ) path.push_back(exit[c]);
+        std::copy(path.begin(), path.end(), cell);
+        return;
+    }
+
+    // local instance: node i is cell[i] (closed), or node 0 is the dummy and node i is cell[i-1] (path)
+    int shift = closed ? 0 : 1;
+    TSP sub;
+    sub.n = m + shift;
+    sub.cost.assign(sub.n, std::vector<double>(sub.n, 0.0));
+    double span = 0.0;
+    for ( int i = 0 ; i < m ; ++i ) {
+        for ( int j = 0 ; j < m ; ++j ) {
+            sub.cost[i+shift][j+shift] = dist(cell[i], cell[j]);
+            span = std::max(span, sub.cost[i+shift][j+shift]);
+        }
+    }
+    int first = -1, last = -1;
+    if ( !closed ) {
+        double M = ( m + 1 ) * span + 1; // longer than any path: the dummy keeps its two free edges
+        for ( int i = 0 ; i < m ; ++i ) {
+            bool end = ( cell[i] == entry[c] || cell[i] == exit[c] );
+            sub.cost[0][i+1] = sub.cost[i+1][0] = end ? 0.0 : M;
+            if ( cell[i] == entry[c] ) first = i + 1;
+            if ( cell[i] == exit[c] ) last = i + 1;
+        }
+    }
+    sub.id.resize(sub.n);
+    std::iota(sub.id.begin(), sub.id.end(), 0);
+    sub.setInfinite();
+
+    TSPSolution init(sub), best(sub);
+    if ( closed ) solver.initHeu1(sub, init);
+    else { // nearest neighbour path from the entry, the exit last
+        std::vector<char> visited(sub.n, 0);
+        visited[0] = visited[first] = visited[last] = 1;
+        int prev = first;
+        init.sequence[1] = first;
+        for ( int k = 2 ; k < m ; ++k ) {
+            int next = -1;
+            for ( int j = 1 ; j < sub.n ; ++j ) {
+                if ( !visited[j] && ( next < 0 || sub.cost[prev][j] < sub.cost[prev][next] ) ) next = j;
+            }
+            init.sequence[k] = next;
+            visited[next] = 1;
+            prev = next;
+        }
+        init.sequence[m] = last;
+    }
+    if ( !solveFixed(sub, init, tabulength, maxIter, best) ) solver.solve(sub, init, tabulength, maxIter, best);
+
+    // back to the holes: the path from the entry to the exit (dummy dropped), or the tour
+    std::vector<int> hole(cell, cell + m);
+    if ( closed ) {
+        for ( int k = 0 ; k < m ; ++k ) cell[k] = hole[best.sequence[k]];
+    }
+    else {
+        bool forward = ( best.sequence[1] == first );
+        for ( int k = 0 ; k < m ; ++k ) cell[k] = hole[best.sequence[forward ? k + 1 : m - k] - 1];
+    }
+}
@@ -0,0 +1,53 @@
+/**
+ * @file Partition.h
+ * @brief TSP partition solver for very large coordinate instances (k-d cells, sub-paths merged, global local search)
+ *
+ */
+
+#pragma once
+
+#include "TSPSolver.h"
+#include "CandidateLocalSearch.h"
+
+/**
+ * Class that solves a large coordinate instance by spatial partitioning (Karp):
+ *  - the plane is split in k-d cells of at most 'cellSize' holes (median cut of the longer side of the box)
+ *  - the cells are visited in the order of a Hilbert curve through their centres; every cell is left by the
+ *    hole closest to the next cell, whose closest hole is the entry of the next cell
+ *  - the path of every cell from its entry to its exit is a tabu search on a small cost matrix with a dummy
+ *    node 0 joined to the entry and the exit (the existing solvers, one cell per thread at a time)
+ *  - the paths are joined in the cell order and the whole tour is improved by 2-opt and Or-opt on neighbour lists
+ * No n x n matrix is built: the instance needs only the hole positions
+ */
+class PartitionSolver
+{
+public:
+
+    PartitionSolver ( int cellSize = 100 , int threads = 1 , int neighbors = 8 )
+        : cellSize(cellSize) , threads(threads) , neighbors(neighbors) { }
+
+    /** solve
+     * @param tsp TSP instance (positions, the cost matrix is not used)
+     * @param tabulength tabu length of the cell searches
+     * @param maxIter iterations of the cell searches
+     * @param bestSol solution found
+     * @return its length
+     */
+    double solve ( const TSP& tsp , int tabulength , int maxIter , TSPSolution& bestSol );
+
+protected:
+    int cellSize;  // holes per cell (at most)
+    int threads;
+    int neighbors; // neighbour list length of the final local search
+
+    std::vector<int> nodes;     // holes grouped by cell: cell c in nodes[cellStart[c] ... cellStart[c+1]-1]
+    std::vector<int> cellStart;
+    std::vector<int> entry;     // first and last hole of the path of every cell
+    std::vector<int> exit;
+
+    /// k-d split of nodes[begin ... end-1] in cells
+    void split ( const TSP& tsp , int begin , int end );
+
+    /// path of cell c from its entry to its exit, written back in its range of nodes
+    void solveCell ( const TSP& tsp , int c , TSPSolver& solver , int tabulength , int maxIter );
+};
@@ -0,0 +1,103 @@
+/**
+ * @file Random.h
+ * @brief seeded random numbers: xoshiro256** generator with independent streams
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <iterator>
+#include <algorithm>
+#include <unistd.h>
+
+/**
+ * Class of a xoshiro256** generator (Blackman, Vigna): 256 bits of state, a few shifts and rotations per number.
+ * A generator is built from the seed of the run and a stream number: its state is the splitmix64 sequence of the two
+ * hashed together, so every thread (or every use) gets its own stream and a run is reproducible from its seed alone.
+ * The seed of the run is set once (--seed), otherwise it mixes the clock, the time and the process id.
+ * Integers and shuffles do not go through <random> distributions, so a seed gives the same numbers with any library
+ */
+class Rng
+{
+public:
+    typedef uint64_t result_type;
+
+    /// streams of the sequential uses; the threads of a parallel solver use THREADS + thread index
+    enum Stream : uint64_t { INSTANCE = 0 , INITIAL = 1 , ESCAPE = 2 , THREADS = 16 };
+
+    explicit Rng ( uint64_t stream = 0 ) { seed(runSeed(), stream); }
+    Rng ( uint64_t seedValue , uint64_t stream ) { seed(seedValue, stream); }
+
+    void seed ( uint64_t seedValue , uint64_t stream ) {
+        uint64_t x = mix(seedValue + mix(stream + 1));
+        for ( int k = 0 ; k < 4 ; ++k ) s[k] = splitmix(x);
+    }
+
+    static constexpr result_type min ( ) { return 0; }
+    static constexpr result_type max ( ) { return UINT64_MAX; }
+
+    result_type operator() ( ) {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    /// uniform integer in [0,n), n > 0 (Lemire: multiply and shift, the few biased products drawn again)
+    uint64_t below ( uint64_t n ) {
+        unsigned __int128 m = (unsigned __int128)(*this)() * n;
+        if ( (uint64_t)m < n ) {
+            uint64_t threshold = -n % n;
+            while ( (uint64_t)m < threshold ) m = (unsigned __int128)(*this)() * n;
+        }
+        return m >> 64;
+    }
+
+    /// uniform real in [0,1)
+    double uniform ( ) { return ( (*this)() >> 11 ) * 0x1.0p-53; }
+
+    /// Fisher-Yates shuffle of [first,last)
+    template <class It>
+    void shuffle ( It first , It last ) {
+        for ( auto k = std::distance(first, last) ; k > 1 ; --k ) std::iter_swap(first + (k - 1), first + below(k));
+    }
+
+    /// partial Fisher-Yates: the first count elements of [first,last) become a uniform sample in random order
+    template <class It>
+    void sample ( It first , It last , long count ) {
+        auto size = std::distance(first, last);
+        for ( long k = 0 ; k < count && k < size - 1 ; ++k ) std::iter_swap(first + k, first + (k + below(size - k)));
+    }
+
+    /// seed of the run, used by every Rng(stream)
+    static uint64_t runSeed ( ) { return seedStore(); }
+    static void setRunSeed ( uint64_t value ) { seedStore() = value; }
+
+    /// seed from the clock, the time and the process id (runs without a given seed)
+    static uint64_t entropySeed ( ) {
+        uint64_t a = clock();
+        uint64_t b = time(NULL);
+        uint64_t c = getpid();
+        return mix(mix(a) ^ mix(b + 1) ^ mix(c + 2));
+    }
+
+private:
+    uint64_t s[4];
+
+    static uint64_t& seedStore ( ) { static uint64_t value = entropySeed(); return value; }
+
+    static uint64_t rotl ( uint64_t x , int k ) { return ( x << k ) | ( x >> (64 - k) ); }
+    static uint64_t mix ( uint64_t z ) { // splitmix64 finaliser
+        z = ( z ^ (z >> 30) ) * 0xBF58476D1CE4E5B9ull;
+        z = ( z ^ (z >> 27) ) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    static uint64_t splitmix ( uint64_t& x ) { return mix(x += 0x9E3779B97F4A7C15ull); }
+};
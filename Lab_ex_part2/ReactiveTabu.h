@@ -0,0 +1,139 @@
+/**
+ * @file ReactiveTabu.h
+ * @brief reactive tabu search memory (visited tours hashing, adaptive tabu length)
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "TSPSolution.h"
+#include "Checkpoint.h"
+
+/**
+ * Class that remembers the tours visited by the tabu search and adapts the tabu length (Battiti & Tecchiolli):
+ *  - a tour is identified by a 64-bit hash of its edge set (XOR of one random key per edge), updated in O(1) per 2-opt move
+ *  - hashes are kept in an open addressing table with the last iteration they were visited
+ *  - a tour seen again after a short cycle increases the tabu length, a long time without cycles decreases it
+ *  - too many tours visited over and over (chaotic trapping) asks for an escape (random moves)
+ */
+class ReactiveTabu
+{
+public:
+    ReactiveTabu ( ) : used(0) { }
+
+    void init ( int nodes , int initTenure ) {
+        n = nodes;
+        maxTenure = std::max(1, n / 2);
+        tenureValue = std::min(std::max(1, initTenure), maxTenure);
+        lastChange = 0;
+        avgCycle = 2 * n;
+        chaotic = 0;
+        clear();
+    }
+
+    int tenure ( ) const { return (int)tenureValue; }
+    double averageCycle ( ) const { return avgCycle; }
+
+    /// random key of the (undirected) edge u-v, from a 64-bit mixer (no table to store)
+    static uint64_t edgeKey ( int u , int v ) {
+        uint64_t z = ( (uint64_t)std::min(u, v) << 32 ) + (uint64_t)std::max(u, v) + 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    static uint64_t tourHash ( const TSPSolution& sol ) {
+        uint64_t h = 0;
+        for ( uint i = 0 ; i + 1 < sol.sequence.size() ; ++i ) h ^= edgeKey(sol.sequence[i], sol.sequence[i+1]);
+        return h;
+    }
+
+    /// hash after reversing the segment [from,to] of sol (edges h-i, j-l replaced by h-j, i-l)
+    static uint64_t moveHash ( uint64_t h , const TSPSolution& sol , int from , int to ) {
+        int a = sol.sequence[from-1], b = sol.sequence[from], c = sol.sequence[to], d = sol.sequence[to+1];
+        return h ^ edgeKey(a, b) ^ edgeKey(c, d) ^ edgeKey(a, c) ^ edgeKey(b, d);
+    }
+
+    /** register the tour reached at iteration iter and react
+     * @param hash tour hash
+     * @param iter current iteration
+     * @return true if the search is trapped and must escape
+     */
+    bool visit ( uint64_t hash , int iter ) {
+        if ( hash == 0 ) hash = 1; // 0 marks the empty slots
+        Entry& e = find(hash);
+        if ( e.key == hash ) {
+            int cycle = iter - e.last;
+            e.last = iter;
+            if ( ++e.reps > REPETITIONS && ++chaotic > CHAOS ) {
+                chaotic = 0;
+                clear();
+                return true;
+            }
+            if ( cycle < CYCLE_MAX ) { // cycling: longer tabu list
+                avgCycle = 0.1 * cycle + 0.9 * avgCycle;
+                tenureValue = std::min(tenureValue * INCREASE + 1, (double)maxTenure);
+                lastChange = iter;
+            }
+        }
+        else {
+            e.key = hash; e.last = iter; e.reps = 1;
+            if ( ++used * 2 > table.size() ) grow();
+        }
+        if ( iter - lastChange > avgCycle ) { // no cycles for a while: shorter tabu list
+            tenureValue = std::max(tenureValue * DECREASE, 1.0);
+            lastChange = iter;
+        }
+        return false;
+    }
+
+    /// the whole memory in a checkpoint
+    void save ( Checkpoint& file ) const {
+        file.put(table); file.put(used); file.put(n); file.put(maxTenure);
+        file.put(tenureValue); file.put(lastChange); file.put(avgCycle); file.put(chaotic);
+    }
+    bool load ( Checkpoint& file ) {
+        return file.get(table) && file.get(used) && file.get(n) && file.get(maxTenure) && file.get(tenureValue)
+               && file.get(lastChange) && file.get(avgCycle) && file.get(chaotic) && !table.empty();
+    }
+
+private:
+    static constexpr double INCREASE    = 1.1;
+    static constexpr double DECREASE    = 0.9;
+    static constexpr int    REPETITIONS = 3;  // visits that make a tour "often repeated"
+    static constexpr int    CHAOS       = 3;  // often repeated tours before an escape
+    static constexpr int    CYCLE_MAX   = 50; // longer returns are not considered cycles
+
+    struct Entry { uint64_t key; int last; int reps; };
+    std::vector<Entry> table; // open addressing, linear probing, size power of 2
+    size_t used;
+
+    int    n;
+    int    maxTenure;
+    double tenureValue;
+    int    lastChange; // iteration of the last tenure change
+    double avgCycle;   // moving average of the detected cycle lengths
+    int    chaotic;
+
+    Entry& find ( uint64_t hash ) {
+        size_t mask = table.size() - 1;
+        size_t k = hash & mask;
+        while ( table[k].key != 0 && table[k].key != hash ) k = (k + 1) & mask;
+        return table[k];
+    }
+
+    void clear ( ) {
+        table.assign(1024, Entry{0, 0, 0});
+        used = 0;
+    }
+
+    void grow ( ) {
+        std::vector<Entry> old;
+        old.swap(table);
+        table.assign(old.size() * 2, Entry{0, 0, 0});
+        for ( const Entry& e : old ) {
+            if ( e.key != 0 ) find(e.key) = e;
+        }
+    }
+};
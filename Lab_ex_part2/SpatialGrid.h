@@ -0,0 +1,180 @@
+/**
+ * @file SpatialGrid.h
+ * @brief uniform grid on the hole positions (nearest node queries, Manhattan distance)
+ *
+ */
+
+#pragma once
+
+#include <cmath>
+#include "TSP.h"
+
+/**
+ * Class that buckets a set of nodes of a coordinate instance in square cells, to find the
+ * nearest node of the set without looking at all of them. Nodes can be removed from the set;
+ * the grid is rebuilt coarser when most of its nodes are gone, so that queries don't scan empty cells
+ */
+class SpatialGrid
+{
+public:
+    SpatialGrid ( const TSP& tsp , int perCell = 2 ) : tsp(tsp) , perCell(perCell) , count(0) { }
+
+    /** build the grid on a set of nodes
+     * @param nodes nodes in the set
+     * @return ---
+     */
+    void build ( const std::vector<int>& nodes )
+    {
+        count = nodes.size();
+        built = count;
+        where.assign(tsp.n, -1);
+        if ( count == 0 ) return;
+
+        x0 = x1 = tsp.coord[nodes[0]][0];
+        y0 = y1 = tsp.coord[nodes[0]][1];
+        for ( int v : nodes ) {
+            x0 = std::min(x0, tsp.coord[v][0]);  x1 = std::max(x1, tsp.coord[v][0]);
+            y0 = std::min(y0, tsp.coord[v][1]);  y1 = std::max(y1, tsp.coord[v][1]);
+        }
+        // about 'perCell' nodes per cell
+        double area = std::max(x1 - x0, 1.0) * std::max(y1 - y0, 1.0);
+        side = std::sqrt(area * perCell / count);
+        nx = std::max(1, (int)std::ceil((x1 - x0) / side) + 1);
+        ny = std::max(1, (int)std::ceil((y1 - y0) / side) + 1);
+
+        // cells stored contiguously: nodes of cell c in items[start[c] ... start[c]+size[c]-1]
+        start.assign(nx*ny + 1, 0);
+        size.assign(nx*ny, 0);
+        for ( int v : nodes ) start[cellOf(v) + 1]++;
+        for ( int c = 0 ; c < nx*ny ; ++c ) start[c+1] += start[c];
+        items.resize(count);
+        for ( int v : nodes ) {
+            int c = cellOf(v);
+            where[v] = start[c] + size[c];
+            items[where[v]] = v;
+            size[c]++;
+        }
+    }
+
+    /** remove a node from the set
+     * @param v node
+     * @return ---
+     */
+    void remove ( int v )
+    {
+        int c = cellOf(v);
+        int last = start[c] + size[c] - 1;
+        int moved = items[last];
+        items[where[v]] = moved;
+        where[moved] = where[v];
+        where[v] = -1;
+        size[c]--;
+        count--;
+
+        if ( count > 0 && count * 4 < built && built > 64 ) { // rebuild coarser on the nodes left
+            std::vector<int> left;
+            left.reserve(count);
+            for ( int k = 0 ; k < nx*ny ; ++k ) {
+                for ( int q = start[k] ; q < start[k] + size[k] ; ++q ) left.push_back(items[q]);
+            }
+            build(left);
+        }
+    }
+
+    /** nearest node of the set (Manhattan distance, ties broken by the lowest index)
+     * @param x , y query point
+     * @return nearest node, -1 if the set is empty
+     */
+    int nearest ( double x , double y ) const
+    {
+        if ( count == 0 ) return -1;
+        int cx = clampX(x), cy = clampY(y);
+        int best = -1;
+        double bestDist = 0;
+
+        auto scan = [&](int gx, int gy) {
+            if ( gx < 0 || gy < 0 || gx >= nx || gy >= ny ) return;
+            int c = gy*nx + gx;
+            for ( int q = start[c] ; q < start[c] + size[c] ; ++q ) {
+                int v = items[q];
+                double d = std::fabs(x - tsp.coord[v][0]) + std::fabs(y - tsp.coord[v][1]);
+                if ( best < 0 || d < bestDist || ( d == bestDist && v < best ) ) { best = v; bestDist = d; }
+            }
+        };
+
+        // rings of cells around the query cell: a node in ring r is at least (r-1)*side away
+        for ( int r = 0 ; r <= std::max(nx, ny) ; ++r ) {
+            if ( best >= 0 && (r - 1) * side > bestDist ) break;
+            for ( int d = -r ; d <= r ; ++d ) {
+                scan(cx + d, cy - r);
+                if ( r > 0 ) scan(cx + d, cy + r);
+            }
+            for ( int d = -r + 1 ; d <= r - 1 ; ++d ) {
+                scan(cx - r, cy + d);
+                scan(cx + r, cy + d);
+            }
+        }
+        return best;
+    }
+
+    /** the K nearest nodes of the set to node v, v excluded (Manhattan distance, ties broken by the lowest index)
+     * @param v query node
+     * @param K number of neighbours
+     * @param out nearest first (at most K, fewer if the set is smaller)
+     * @return ---
+     */
+    void nearestK ( int v , int K , std::vector<int>& out ) const
+    {
+        out.clear();
+        if ( count == 0 || K <= 0 ) return;
+        double x = tsp.coord[v][0], y = tsp.coord[v][1];
+        int cx = clampX(x), cy = clampY(y);
+        std::vector<double> dist; // distances of out, kept sorted by insertion
+
+        auto scan = [&](int gx, int gy) {
+            if ( gx < 0 || gy < 0 || gx >= nx || gy >= ny ) return;
+            int c = gy*nx + gx;
+            for ( int q = start[c] ; q < start[c] + size[c] ; ++q ) {
+                int u = items[q];
+                if ( u == v ) continue;
+                double d = std::fabs(x - tsp.coord[u][0]) + std::fabs(y - tsp.coord[u][1]);
+                if ( (int)out.size() == K && ( d > dist.back() || ( d == dist.back() && u > out.back() ) ) ) continue;
+                int k = out.size();
+                if ( k == K ) { out.pop_back(); dist.pop_back(); k--; }
+                out.push_back(u);
+                dist.push_back(d);
+                for ( ; k > 0 && ( dist[k-1] > d || ( dist[k-1] == d && out[k-1] > u ) ) ; --k ) {
+                    std::swap(out[k], out[k-1]);
+                    std::swap(dist[k], dist[k-1]);
+                }
+            }
+        };
+
+        for ( int r = 0 ; r <= std::max(nx, ny) ; ++r ) {
+            if ( (int)out.size() == K && (r - 1) * side > dist.back() ) break;
+            for ( int d = -r ; d <= r ; ++d ) {
+                scan(cx + d, cy - r);
+                if ( r > 0 ) scan(cx + d, cy + r);
+            }
+            for ( int d = -r + 1 ; d <= r - 1 ; ++d ) {
+                scan(cx - r, cy + d);
+                scan(cx + r, cy + d);
+            }
+        }
+    }
+
+    int nodes ( ) const { return count; }
+
+private:
+    const TSP& tsp;
+    int perCell;
+    int count;  // nodes in the set
+    int built;  // nodes in the set when the grid was built
+    double x0, x1, y0, y1, side;
+    int nx, ny;
+    std::vector<int> start, size, items, where;
+
+    int clampX ( double x ) const { return std::min(nx - 1, std::max(0, (int)((x - x0) / side))); }
+    int clampY ( double y ) const { return std::min(ny - 1, std::max(0, (int)((y - y0) / side))); }
+    int cellOf ( int v ) const { return clampY(tsp.coord[v][1]) * nx + clampX(tsp.coord[v][0]); }
+};
@@ -11,6 +11,10 @@
 #include <vector>
 #include <random>
 #include <algorithm>
+#include <numeric>
+#include <unordered_set>
+#include <unistd.h>
+#include "Random.h"
 
 #define PRINT_ALL_TPSOLVER 0 // print all info for debug and to understand evolution
 
@@ -24,6 +28,8 @@ public:
     int n; //number of nodes
     std::vector< std::vector<double> > cost;
     double infinite; // infinite value (an upper bound on the value of any feasible solution)
+    std::vector< std::vector<double> > coord; // hole positions (empty if the instance was read as a cost matrix)
+    std::vector<int> id; // original id of each node (identity unless renumbered)
 
     void readDists(const char* filename) // read cost matrix from file
     {
@@ -31,6 +37,7 @@ public:
 
         // read size
         in >> n;
+        coord.clear();
 
         #if PRINT_ALL_TPSOLVER
             std::cout << "(Dists) number of nodes n = " << n << std::endl;
@@ -48,6 +55,8 @@ public:
         }
         in.close();
 
+        id.resize(n);
+        std::iota(id.begin(), id.end(), 0);
         setInfinite();
     }
 
@@ -61,7 +70,7 @@ public:
         infinite *= 2;
     }
 
-    void readPos(const char* filename) // read positions from file
+    void readPos(const char* filename, bool costs = true) // read positions from file (costs false: no cost matrix)
     {
         std::ifstream in(filename);
 
@@ -86,12 +95,31 @@ public:
         in.close();
 
         // compute costs
-        computeCost(pos);
+        if (costs) computeCost(pos);
+        else setPositions(pos);
         return;
     }
 
+    // positions only, for boards too large for a cost matrix (cost stays empty, distances from coord)
+    void setPositions(const std::vector<std::vector<double>>& pos)
+    {
+        coord = pos;
+        cost.clear();
+        id.resize(n);
+        std::iota(id.begin(), id.end(), 0);
+        double x0 = 0, x1 = 0, y0 = 0, y1 = 0;
+        for (int i = 0; i < n; i++) {
+            if (i == 0 || pos[i][0] < x0) x0 = pos[i][0];
+            if (i == 0 || pos[i][0] > x1) x1 = pos[i][0];
+            if (i == 0 || pos[i][1] < y0) y0 = pos[i][1];
+            if (i == 0 || pos[i][1] > y1) y1 = pos[i][1];
+        }
+        infinite = 2.0 * n * ((x1 - x0) + (y1 - y0)) + 1; // every edge is at most the bounding box half perimeter
+    }
+
     void computeCost(const std::vector<std::vector<double>>& pos) // compute costs from positions
     {
+        coord = pos;
         cost.resize(n);
         for (int i = 0; i < n; i++) {
             cost[i].reserve(n);
@@ -100,31 +128,73 @@ public:
                 cost[i].push_back(c);
             }
         }
+        id.resize(n);
+        std::iota(id.begin(), id.end(), 0);
         setInfinite();
         return;
     }
 
-    // better seed for srand() using a mix function
-    unsigned long superSeed()
-    {	
-        unsigned long a = clock();
-        unsigned long b = time(NULL);
-        unsigned long c = getpid();
-        a=a-b;  a=a-c;  a=a^(c >> 13);
-        b=b-c;  b=b-a;  b=b^(a << 8);
-        c=c-a;  c=c-b;  c=c^(b >> 13);
-        a=a-b;  a=a-c;  a=a^(c >> 12);
-        b=b-c;  b=b-a;  b=b^(a << 16);
-        c=c-a;  c=c-b;  c=c^(b >> 5);
-        a=a-b;  a=a-c;  a=a^(c >> 3);
-        b=b-c;  b=b-a;  b=b^(a << 10);
-        c=c-a;  c=c-b;  c=c^(b >> 15);
-        return c;
+    // nodes sorted along a Hilbert curve through the hole positions, rotated to start from node 0
+    std::vector<int> hilbertOrder() const
+    {
+        std::vector<int> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        if (coord.empty()) return order;
+
+        double x0 = coord[0][0], x1 = x0, y0 = coord[0][1], y1 = y0;
+        for (int i = 0; i < n; i++) {
+            x0 = std::min(x0, coord[i][0]);  x1 = std::max(x1, coord[i][0]);
+            y0 = std::min(y0, coord[i][1]);  y1 = std::max(y1, coord[i][1]);
+        }
+        const unsigned side = 1u << 16;
+        double scale = (side - 1) / std::max(std::max(x1 - x0, y1 - y0), 1e-9);
+
+        std::vector<unsigned long long> key(n);
+        for (int i = 0; i < n; i++) {
+            unsigned x = (coord[i][0] - x0) * scale;
+            unsigned y = (coord[i][1] - y0) * scale;
+            unsigned long long d = 0;
+            for (unsigned s = side / 2; s > 0; s /= 2) { // distance along the curve (xy2d)
+                unsigned rx = (x & s) > 0;
+                unsigned ry = (y & s) > 0;
+                d += (unsigned long long)s * s * ((3 * rx) ^ ry);
+                if (ry == 0) { // rotate the quadrant
+                    if (rx == 1) { x = side - 1 - x; y = side - 1 - y; }
+                    std::swap(x, y);
+                }
+            }
+            key[i] = d;
+        }
+        std::sort(order.begin(), order.end(), [&](int a, int b){ return key[a] < key[b] || (key[a] == key[b] && a < b); });
+        std::rotate(order.begin(), std::find(order.begin(), order.end(), 0), order.end());
+        return order;
+    }
+
+    // renumber the nodes: new node k is the current node order[k] (order[0] must be 0)
+    // nodes close in 'order' get close rows of the cost matrix; id keeps the original numbering
+    void renumber(const std::vector<int>& order)
+    {
+        std::vector< std::vector<double> > newCost(n, std::vector<double>(n));
+        for (int a = 0; a < n; a++) {
+            for (int b = 0; b < n; b++) newCost[a][b] = cost[order[a]][order[b]];
+        }
+        cost.swap(newCost);
+
+        std::vector<int> newId(n);
+        for (int a = 0; a < n; a++) newId[a] = id[order[a]];
+        id.swap(newId);
+
+        if (!coord.empty()) {
+            std::vector< std::vector<double> > newCoord(n);
+            for (int a = 0; a < n; a++) newCoord[a] = coord[order[a]];
+            coord.swap(newCoord);
+        }
     }
 
-    void randomCost(const int N, const int classe) // random positions generations
+    void randomCost(const int N, const int classe, bool costs = true) // random positions generations
     {
         n = N;
+        if (!costs) return randomPositions(N, classe);
 
         #if PRINT_ALL_TPSOLVER
             std::cout << "(Random class " << classe << " ) number of nodes n = " << n << std::endl;
@@ -162,8 +232,8 @@ public:
             std::cout << "All pairs done\n";
         #endif
 
-        std::srand(superSeed());
-        std::random_shuffle(allPos.begin(),allPos.end()); // shuffle all pairs
+        Rng rng(Rng::INSTANCE);
+        rng.sample(allPos.begin(), allPos.end(), n); // n pairs drawn at random (same instance for the same seed)
 
         pos.resize(n);
         for (int i = 0; i < n; i++) {
@@ -180,5 +250,26 @@ public:
         return;
     }
 
+    // N distinct random lattice positions, same classes as randomCost, without the list of all the pairs
+    // (rejection sampling: the lattice has about N^2 cells, so few draws are rejected), no cost matrix
+    void randomPositions(const int N, const int classe)
+    {
+        n = N;
+        long long min = (classe == 1) ? 0 : 1;
+        long long side = (classe == 1) ? n : n - 2;
+        Rng rng(Rng::INSTANCE);
+        std::unordered_set<long long> taken;
+        taken.reserve(n);
+        std::vector<std::vector<double>> pos(n, std::vector<double>(2));
+        for (int i = 0; i < n; ) {
+            long long c = rng.below(side * side);
+            if (!taken.insert(c).second) continue;
+            pos[i][0] = min + c / side;
+            pos[i][1] = min + c % side;
+            i++;
+        }
+        setPositions(pos);
+    }
+
 };
 
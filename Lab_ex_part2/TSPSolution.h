@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include "TSP.h"
 
 /**
@@ -40,6 +41,108 @@ public:
         }
     }
     public:
+    /** set the sequence from a tour given by adjacency
+     * @param adj the two tour neighbours of node v in adj[2v] and adj[2v+1]
+     * @return ---
+     */
+    void fromAdjacency ( const std::vector<int>& adj ) {
+        int n = sequence.size() - 1;
+        int prev = 0, node = adj[1];
+        sequence[0] = 0;
+        for ( int k = 1 ; k < n ; ++k ) {
+            sequence[k] = node;
+            int next = ( adj[2*node] == prev ) ? adj[2*node+1] : adj[2*node];
+            prev = node;
+            node = next;
+        }
+        sequence[n] = 0;
+    }
+    /** check that the solution is a tour: n+1 positions, from node 0 back to node 0, every node once
+     * @param tsp TSP instance the solution refers to
+     * @return true if valid
+     */
+    bool isTour ( const TSP& tsp ) const {
+        int n = tsp.n;
+        if ( (int)sequence.size() != n + 1 || sequence[0] != 0 || sequence[n] != 0 ) return false;
+        std::vector<char> seen(n, 0);
+        for ( int k = 0 ; k < n ; ++k ) {
+            int v = sequence[k];
+            if ( v < 0 || v >= n || seen[v] ) return false;
+            seen[v] = 1;
+        }
+        return true;
+    }
+    /** original node ids (for an instance renumbered by TSP::renumber)
+     * @param tsp TSP instance the solution refers to
+     * @return ---
+     */
+    void restoreIds ( const TSP& tsp ) {
+        for ( uint i = 0; i < sequence.size(); i++ ) sequence[i] = tsp.id[sequence[i]];
+    }
+    /** write the tour to a file with the original hole ids, starting from node 0 (without coming back to it)
+     *  text: the number of holes, then the holes;  binary: "TOUR", the number of holes, the holes (32 bit integers)
+     * @param tsp TSP instance the solution refers to
+     * @param filename output file
+     * @param binary binary format
+     * @return true if written
+     */
+    bool write ( const TSP& tsp , const char* filename , bool binary = false ) const {
+        int n = sequence.size() - 1;
+        std::ofstream out(filename, binary ? std::ios::binary : std::ios::out);
+        if ( !out ) return false;
+        if ( binary ) {
+            int32_t header[2] = { 0x52554F54 , n }; // "TOUR" little endian
+            out.write((const char*)header, sizeof(header));
+            std::vector<int32_t> ids(n);
+            for ( int k = 0 ; k < n ; ++k ) ids[k] = tsp.id[sequence[k]];
+            out.write((const char*)ids.data(), n * sizeof(int32_t));
+        }
+        else {
+            out << n << "\n";
+            for ( int k = 0 ; k < n ; ++k ) out << tsp.id[sequence[k]] << ( k + 1 < n ? " " : "\n" );
+        }
+        return bool(out);
+    }
+    /** read a tour written by write (format detected), from any start: it must visit every hole of tsp once
+     * @param tsp TSP instance (original ids in tsp.id)
+     * @param filename input file
+     * @return true if the file holds a tour of tsp (the solution is unchanged otherwise)
+     */
+    bool read ( const TSP& tsp , const char* filename ) {
+        std::ifstream in(filename, std::ios::binary);
+        if ( !in ) return false;
+        std::vector<int> ids;
+        int32_t header[2];
+        if ( in.read((char*)header, sizeof(header)) && header[0] == 0x52554F54 ) {
+            if ( header[1] != tsp.n ) return false;
+            std::vector<int32_t> raw(tsp.n);
+            if ( !in.read((char*)raw.data(), tsp.n * sizeof(int32_t)) ) return false;
+            ids.assign(raw.begin(), raw.end());
+        }
+        else {
+            in.clear();
+            in.seekg(0);
+            int n;
+            if ( !(in >> n) || n != tsp.n ) return false;
+            ids.resize(n);
+            for ( int k = 0 ; k < n ; ++k ) if ( !(in >> ids[k]) ) return false;
+        }
+
+        // original ids to nodes, every node once
+        int maxId = tsp.n ? *std::max_element(tsp.id.begin(), tsp.id.end()) : 0;
+        std::vector<int> nodeOf(maxId + 1, -1);
+        for ( int v = 0 ; v < tsp.n ; ++v ) nodeOf[tsp.id[v]] = v;
+        std::vector<char> seen(tsp.n, 0);
+        for ( int& v : ids ) {
+            if ( v < 0 || v > maxId || nodeOf[v] < 0 || seen[nodeOf[v]] ) return false;
+            v = nodeOf[v];
+            seen[v] = 1;
+        }
+        std::rotate(ids.begin(), std::find(ids.begin(), ids.end(), 0), ids.end());
+        sequence.assign(ids.begin(), ids.end());
+        sequence.push_back(0);
+        return true;
+    }
     /** print method 
      * @param ---
      * @return ---
@@ -6,6 +6,8 @@
 
 #include "TSPSolver.h"
 #include <iostream>
+#include <chrono>
+#include <stdexcept>
 
 bool TSPSolver::solve ( const TSP& tsp , const TSPSolution& initSol , int tabulength , int maxIter , TSPSolution& bestSol )   /// TS: new param
 {
@@ -16,13 +18,48 @@ bool TSPSolver::solve ( const TSP& tsp , const TSPSolution& initSol , int tabule
 
         ///Tabu Search
         tabuLength = tabulength;
-        tabuList.reserve(tsp.n);
-        initTabuList(tsp.n);
+        initTabuList(tsp.n, reactive ? std::max(tabulength, tsp.n / 2) : tabulength);
         
         TSPSolution currSol(initSol);
         double bestValue, currValue, initValue;
         initValue = bestValue = currValue = evaluate(currSol,tsp);
         TSPMove move;
+        stop = ( initValue <= lowerBound + 1e-9 ); /// the initial solution is already optimal
+
+        uint64_t currHash = 0;
+        if (reactive) {
+            reactiveMemory.init(tsp.n, tabulength);
+            tabuLength = reactiveMemory.tenure();
+            currHash = ReactiveTabu::tourHash(currSol);
+            reactiveMemory.visit(currHash, 0);
+        }
+
+        int lastImprovement = 0;   /// long-term memory: diversify after 'stagnation' iterations without improvement
+        int diversifyLeft = 0;
+        penaltyFactor = 0;
+        if (stagnation > 0) frequency.assign(tsp.n * tsp.n, 0);
+        eliteAge = -1;
+        position.resize(tsp.n);
+        deltaValid = false;
+        rng.seed(Rng::runSeed(), Rng::ESCAPE);
+
+        TSPSolution startSol(initSol);
+        if (!checkpointFile.empty()) {              /// resume an interrupted search
+            SearchState state;
+            if (loadCheckpoint(tsp, startSol, currSol, bestSol, state)) {
+                iter = state.iter;
+                initValue = state.initValue;
+                bestValue = state.bestValue;
+                currValue = state.currValue;
+                currHash = state.hash;
+                lastImprovement = state.lastImprovement;
+                diversifyLeft = state.diversifyLeft;
+                stop = ( iter > maxIter ) || ( bestValue <= lowerBound + 1e-9 );
+            }
+        }
+        auto lastCheckpoint = std::chrono::steady_clock::now();
+        budget.start();
+        bool interrupted = false;
 
         while (!stop) 
         {
@@ -33,6 +70,12 @@ bool TSPSolver::solve ( const TSP& tsp , const TSPSolution& initSol , int tabule
                 std::cout << " (" << iter << "ac) value " << currValue << "\t(" << evaluate(currSol,tsp) << ")";
             #endif
 
+            if (diversifyLeft > 0) {                /// diversification phase: frequent edges are penalised
+                penaltyFactor = penaltyWeight * currValue / iter; // (average edge cost) / (iter / n)
+                --diversifyLeft;
+            }
+            else penaltyFactor = 0;
+
             double aspiration = bestValue-currValue;                                                            
             double bestNeighValue = currValue + findBestNeighbor(tsp,currSol,iter,aspiration,move);             
             
@@ -50,22 +93,65 @@ bool TSPSolver::solve ( const TSP& tsp , const TSPSolution& initSol , int tabule
                 std::cout << "\tmove: " << move.from << " , " << move.to;
             #endif
             
-            updateTabuList(currSol.sequence[move.from],currSol.sequence[move.to],iter);	/// insert move info into tabu list
+            updateTabuList(currSol,move,iter);	/// insert move info into tabu list
+            if (stagnation > 0) updateFrequency(currSol, move, tsp.n);
+            if (reactive) currHash = ReactiveTabu::moveHash(currHash, currSol, move.from, move.to);
                         
             currSol = swap(currSol,move);                                                                       
             currValue = bestNeighValue;                                                                 
+            if (exploration == ELITE_LIST) updatePositions(currSol, move);
+            if (deltaValid) updateDeltas(tsp, currSol, move);
+
+            if (reactive) {                         /// RTS: react to cycles (tabu length) and chaotic trapping (escape)
+                if (reactiveMemory.visit(currHash, iter)) {
+                    if ( currValue < bestValue - 0.01 ) {
+                        bestValue = currValue;
+                        bestSol = currSol;
+                        if (onImprovement) onImprovement(bestSol, bestValue, iter);
+                    }
+                    currValue = escape(tsp, currSol, currValue, currHash, iter);
+                    eliteAge = -1;
+                    deltaValid = false;
+                }
+                tabuLength = reactiveMemory.tenure();
+            }
             if ( currValue < bestValue - 0.01 ) {	/// TS: update incumbent (if better -with tolerance- solution found)
                 bestValue = currValue;                                                                           
                 bestSol = currSol;   
+                lastImprovement = iter;
+                if (onImprovement) onImprovement(bestSol, bestValue, iter);
 
                 #if PRINT_ALL_TPSOLVER
                     std::cout << "\t***";
                 #endif
+
+                if ( bestValue <= lowerBound + 1e-9 ) stop = true; /// incumbent meets the lower bound: optimal
             }           
+            else if (stagnation > 0 && diversifyLeft == 0 && iter - lastImprovement >= stagnation) {
+                diversifyLeft = diversifyLength;
+                lastImprovement = iter; // next phase after other 'stagnation' iterations at least
+
+                #if PRINT_ALL_TPSOLVER
+                    std::cout << "\tdiversify";
+                #endif
+            }
             
             if (iter > maxIter) { 
                 stop = true;      
             } 
+            else if (budget.exhausted()) {              /// out of time, or cancelled: the incumbent is the result
+                stop = true;
+                interrupted = budget.cancelled();
+            }
+
+            if (!stop && !checkpointFile.empty()) {     /// save the state after a whole iteration
+                auto now = std::chrono::steady_clock::now();
+                if (std::chrono::duration<double>(now - lastCheckpoint).count() >= checkpointEvery) {
+                    saveCheckpoint(tsp, startSol, currSol, bestSol,
+                                   SearchState{iter, initValue, bestValue, currValue, currHash, lastImprovement, diversifyLeft});
+                    lastCheckpoint = now;
+                }
+            }
             
             #if PRINT_ALL_TPSOLVER
                 std::cout << std::endl;
@@ -73,14 +159,22 @@ bool TSPSolver::solve ( const TSP& tsp , const TSPSolution& initSol , int tabule
             
         }
         //bestSol = currSol;    /// TS: not always the neighbor improves over the best available (incumbent) solution 
+        if (!checkpointFile.empty()) {
+            if (interrupted) saveCheckpoint(tsp, startSol, currSol, bestSol,       /// cancelled: resumed by the next run
+                                            SearchState{iter, initValue, bestValue, currValue, currHash, lastImprovement, diversifyLeft});
+            else std::remove(checkpointFile.c_str());                             /// finished: nothing to resume
+        }
         if (initValue == bestValue ){
-            bestSol = initSol; // stay with the best solution
+            bestSol = startSol; // stay with the best solution
             #if PRINT_ALL_TPSOLVER
                 std::cout << "Initial solution was the best found\n"; 
             #endif
         }
            
     }
+    catch(CheckpointError&){
+        throw; // no result to return: the run must not look finished
+    }
     catch(std::exception& e){
         std::cout << ">>>EXCEPTION: " << e.what() << std::endl;
         return false;
@@ -88,6 +182,102 @@ bool TSPSolver::solve ( const TSP& tsp , const TSPSolution& initSol , int tabule
     return true;
     }
 
+    double TSPSolver::escape ( const TSP& tsp , TSPSolution& currSol , double currValue , uint64_t& hash , int iter )
+    {
+        int free = currSol.sequence.size() - 2; // positions 1 ... n-1
+        int steps = 1 + (int)(reactiveMemory.averageCycle() / 2);
+        for ( int k = 0 ; k < steps && free > 1 ; ++k ) {
+            TSPMove m;
+            m.from = 1 + rng.below(free);
+            m.to   = 1 + rng.below(free);
+            if ( m.from == m.to ) continue;
+            if ( m.from > m.to ) std::swap(m.from, m.to);
+            int h = currSol.sequence[m.from-1], i = currSol.sequence[m.from];
+            int j = currSol.sequence[m.to],     l = currSol.sequence[m.to+1];
+            currValue += - tsp.cost[h][i] - tsp.cost[j][l] + tsp.cost[h][j] + tsp.cost[i][l];
+            hash = ReactiveTabu::moveHash(hash, currSol, m.from, m.to);
+            updateTabuList(currSol, m, iter);
+            std::reverse(currSol.sequence.begin() + m.from, currSol.sequence.begin() + m.to + 1);
+        }
+
+        #if PRINT_ALL_TPSOLVER
+            std::cout << "\tescape (" << steps << " random moves)";
+        #endif
+
+        return currValue;
+    }
+
+    static const uint32_t CHECKPOINT_MAGIC = 0x4B434654; // "TFCK"
+
+    void TSPSolver::saveCheckpoint ( const TSP& tsp , const TSPSolution& initSol , const TSPSolution& currSol ,
+                                     const TSPSolution& bestSol , const SearchState& state )
+    {
+        Checkpoint file;
+        file.put(CHECKPOINT_MAGIC);
+        file.put(tsp.n); file.put(tsp.infinite); // the instance ...
+        file.put(tabuRule); file.put(reactive); file.put(stagnation); file.put(exploration); // ... and the options
+        file.put(state);
+        file.put(initSol.sequence); file.put(currSol.sequence); file.put(bestSol.sequence);
+        file.put(tabuLength);
+        if (tabuRule == EDGE_TABU) edgeTabu.save(file);
+        else nodeTabu.save(file);
+        if (reactive) reactiveMemory.save(file);
+        if (stagnation > 0) file.put(frequency);
+        if (exploration == ELITE_LIST) {
+            file.put(elite); file.put(eliteWorst); file.put(eliteAge); file.put(position);
+        }
+        if (exploration == DELTA_TABLE) {
+            file.put(deltaValid);
+            if (deltaValid) { file.put(delta); file.put(rowStart); file.put(rowMin); file.put(rowArg); }
+        }
+        file.put(rng);
+
+        if (!file.save(checkpointFile)) throw CheckpointError("cannot write the checkpoint " + checkpointFile);
+
+        #if PRINT_ALL_TPSOLVER
+            std::cout << "\tcheckpoint";
+        #endif
+    }
+
+    bool TSPSolver::loadCheckpoint ( const TSP& tsp , TSPSolution& initSol , TSPSolution& currSol , TSPSolution& bestSol ,
+                                     SearchState& state )
+    {
+        Checkpoint file;
+        if (!file.load(checkpointFile)) return false;
+        uint32_t magic;
+        int n, stagnationSaved;
+        double infinite;
+        TabuRule ruleSaved;
+        bool reactiveSaved;
+        Exploration explorationSaved;
+        bool ok = file.get(magic) && magic == CHECKPOINT_MAGIC
+                  && file.get(n) && n == tsp.n && file.get(infinite) && infinite == tsp.infinite
+                  && file.get(ruleSaved) && ruleSaved == tabuRule && file.get(reactiveSaved) && reactiveSaved == reactive
+                  && file.get(stagnationSaved) && stagnationSaved == stagnation
+                  && file.get(explorationSaved) && explorationSaved == exploration;
+        if (!ok) throw CheckpointError("the checkpoint " + checkpointFile + " is not a search of this instance with these options");
+
+        ok = file.get(state) && file.get(initSol.sequence) && file.get(currSol.sequence) && file.get(bestSol.sequence)
+             && (int)initSol.sequence.size() == n+1 && (int)currSol.sequence.size() == n+1 && (int)bestSol.sequence.size() == n+1
+             && file.get(tabuLength)
+             && ( tabuRule == EDGE_TABU ? edgeTabu.load(file, n) : nodeTabu.load(file, n) )
+             && ( !reactive || reactiveMemory.load(file) )
+             && ( stagnation <= 0 || file.get(frequency) );
+        if (ok && exploration == ELITE_LIST) ok = file.get(elite) && file.get(eliteWorst) && file.get(eliteAge) && file.get(position);
+        if (ok && exploration == DELTA_TABLE) {
+            ok = file.get(deltaValid);
+            if (ok && deltaValid) ok = file.get(delta) && file.get(rowStart) && file.get(rowMin) && file.get(rowArg);
+        }
+        ok = ok && file.get(rng) && file.finished();
+        if (!ok) throw CheckpointError("the checkpoint " + checkpointFile + " is damaged");
+
+        #if PRINT_ALL_TPSOLVER
+            std::cout << "resumed at iteration " << state.iter << std::endl;
+        #endif
+
+        return true;
+    }
+
     TSPSolution& TSPSolver::swap ( TSPSolution& tspSol , const TSPMove& move ) 
     {
         TSPSolution tmpSol(tspSol);
@@ -100,13 +290,206 @@ bool TSPSolver::solve ( const TSP& tsp , const TSPSolution& initSol , int tabule
 
 
 double TSPSolver::findBestNeighbor ( const TSP& tsp , const TSPSolution& currSol , int currIter , double aspiration , TSPMove& move )    
+{
+    if ( penaltyFactor > 0 ) {
+        if ( tabuRule == EDGE_TABU ) return scanNeighbors<EdgeTabuList, true>(tsp, currSol, currIter, aspiration, move, edgeTabu);
+        return scanNeighbors<NodeTabuList, true>(tsp, currSol, currIter, aspiration, move, nodeTabu);
+    }
+    if ( exploration == ELITE_LIST ) {
+        if ( tabuRule == EDGE_TABU ) return eliteNeighbors(tsp, currSol, currIter, aspiration, move, edgeTabu);
+        return eliteNeighbors(tsp, currSol, currIter, aspiration, move, nodeTabu);
+    }
+    if ( exploration == DELTA_TABLE ) {
+        if ( !deltaValid ) buildDeltas(tsp, currSol);
+        if ( tabuRule == EDGE_TABU ) return tableNeighbors(tsp, currSol, currIter, aspiration, move, edgeTabu);
+        return tableNeighbors(tsp, currSol, currIter, aspiration, move, nodeTabu);
+    }
+    if ( tabuRule == EDGE_TABU ) return scanNeighbors<EdgeTabuList, false>(tsp, currSol, currIter, aspiration, move, edgeTabu);
+    return scanNeighbors<NodeTabuList, false>(tsp, currSol, currIter, aspiration, move, nodeTabu);
+}
+
+template <class Tabu>
+double TSPSolver::tableNeighbors ( const TSP& tsp , const TSPSolution& currSol , int currIter , double aspiration , TSPMove& move , const Tabu& tabu )
+{
+    // same choice as the full scan: smallest variation, ties broken by the first (a,b) in scan order
+    int n = tsp.n;
+    double bestCostVariation = tsp.infinite;
+    int bestA = n, bestB = n;
+    auto allowed = [&](int a, int b, double d) {
+        int h = currSol.sequence[a-1], i = currSol.sequence[a], j = currSol.sequence[b], l = currSol.sequence[b+1];
+        return !tabu.isTabu(h,i,j,l,currIter,tabuLength) || d < aspiration-0.01;
+    };
+    auto better = [&](double d, int a, int b) {
+        return d < bestCostVariation || ( d == bestCostVariation && ( a < bestA || ( a == bestA && b < bestB ) ) );
+    };
+
+    // first the row minima that are allowed, then only the rows whose minimum is tabu and could do better
+    for ( int a = 1 ; a <= n - 2 ; ++a ) {
+        if ( better(rowMin[a], a, rowArg[a]) && allowed(a, rowArg[a], rowMin[a]) ) {
+            bestCostVariation = rowMin[a];
+            bestA = a; bestB = rowArg[a];
+        }
+    }
+    for ( int a = 1 ; a <= n - 2 ; ++a ) {
+        if ( !better(rowMin[a], a, rowArg[a]) ) continue;
+        const double* row = &delta[rowStart[a]] - (a + 1);
+        for ( int b = a + 1 ; b <= n - 1 ; ++b ) {
+            if ( better(row[b], a, b) && allowed(a, b, row[b]) ) {
+                bestCostVariation = row[b];
+                bestA = a; bestB = b;
+            }
+        }
+    }
+    move.from = bestA;
+    move.to = bestB;
+    return bestCostVariation;
+}
+
+void TSPSolver::buildDeltas ( const TSP& tsp , const TSPSolution& sol )
+{
+    int n = tsp.n;
+    rowStart.assign(n, 0);
+    for ( int a = 2 ; a <= n - 2 ; ++a ) rowStart[a] = rowStart[a-1] + (n - a); // row a-1 has n-a entries
+    delta.resize( n >= 3 ? rowStart[n-2] + 1 : 0 );
+    rowMin.assign(n, tsp.infinite);
+    rowArg.assign(n, n);
+    for ( int a = 1 ; a <= n - 2 ; ++a ) {
+        double* row = &delta[rowStart[a]] - (a + 1);
+        for ( int b = a + 1 ; b <= n - 1 ; ++b ) row[b] = moveDelta(tsp, sol, a, b);
+        rowMinimum(a, n);
+    }
+    deltaValid = true;
+}
+
+void TSPSolver::rowMinimum ( int a , int n )
+{
+    const double* row = &delta[rowStart[a]] - (a + 1);
+    rowMin[a] = row[a+1];
+    rowArg[a] = a + 1;
+    for ( int b = a + 2 ; b <= n - 1 ; ++b ) {
+        if ( row[b] < rowMin[a] ) { rowMin[a] = row[b]; rowArg[a] = b; }
+    }
+}
+
+void TSPSolver::updateDeltas ( const TSP& tsp , const TSPSolution& sol , const TSPMove& move )
+{
+    int n = tsp.n;
+    int f = move.from, t = move.to;
+    auto at = [&](int a, int b) -> double& { return delta[rowStart[a] + (b - a - 1)]; };
+
+    // moves with all four nodes in the segment: re-indexed, (a,b) <-> (f+t-b,f+t-a)
+    for ( int a = f + 1 ; a <= t - 2 ; ++a ) {
+        for ( int b = a + 1 ; b <= t - 1 ; ++b ) {
+            int a2 = f + t - b, b2 = f + t - a;
+            if ( a < a2 || ( a == a2 && b < b2 ) ) std::swap(at(a, b), at(a2, b2));
+        }
+    }
+    // rows starting in the segment (or at its ends): the rest of the row is computed again
+    for ( int a = std::max(1, f) ; a <= std::min(t + 1, n - 2) ; ++a ) {
+        double* row = &delta[rowStart[a]] - (a + 1);
+        int b0 = ( a > f ) ? std::max(a + 1, t) : a + 1;
+        for ( int b = b0 ; b <= n - 1 ; ++b ) row[b] = moveDelta(tsp, sol, a, b);
+        rowMinimum(a, n);
+    }
+    // rows before the segment: only the columns ending in it change
+    int lo = std::max(1, f - 1), hi = std::min(t, n - 1);
+    for ( int a = 1 ; a < f && a <= n - 2 ; ++a ) {
+        double* row = &delta[rowStart[a]] - (a + 1);
+        double minC = tsp.infinite;
+        int argC = n;
+        for ( int b = std::max(lo, a + 1) ; b <= hi ; ++b ) {
+            row[b] = moveDelta(tsp, sol, a, b);
+            if ( row[b] < minC ) { minC = row[b]; argC = b; }
+        }
+        if ( rowArg[a] >= lo && rowArg[a] <= hi ) { // the old minimum changed
+            if ( minC <= rowMin[a] ) { rowMin[a] = minC; rowArg[a] = argC; }
+            else rowMinimum(a, n);
+        }
+        else if ( minC < rowMin[a] || ( minC == rowMin[a] && argC < rowArg[a] ) ) { rowMin[a] = minC; rowArg[a] = argC; }
+    }
+}
+
+template <class Tabu>
+double TSPSolver::eliteNeighbors ( const TSP& tsp , const TSPSolution& currSol , int currIter , double aspiration , TSPMove& move , const Tabu& tabu )
+{
+    if ( eliteAge < 0 || eliteAge >= std::max(1, eliteSize / 2) ) return eliteRescan(tsp, currSol, currIter, aspiration, move, tabu);
+    ++eliteAge;
+
+    // O(K): re-score the kept moves at the current positions of their nodes
+    double bestCostVariation = tsp.infinite;
+    for ( const EliteMove& m : elite ) {
+        int a = std::min(position[m.i], position[m.j]);
+        int b = std::max(position[m.i], position[m.j]);
+        int h = currSol.sequence[a-1], i = currSol.sequence[a];
+        int j = currSol.sequence[b],   l = currSol.sequence[b+1];
+        double neighCostVariation = - tsp.cost[h][i] - tsp.cost[j][l] + tsp.cost[h][j] + tsp.cost[i][l] ;
+
+        if ( tabu.isTabu(h,i,j,l,currIter,tabuLength) && !(neighCostVariation < aspiration-0.01) ) continue;
+        if ( neighCostVariation < bestCostVariation ) {
+            bestCostVariation = neighCostVariation;
+            move.from = a;
+            move.to = b;
+        }
+    }
+
+    if ( bestCostVariation > eliteWorst ) return eliteRescan(tsp, currSol, currIter, aspiration, move, tabu); // list degraded
+    return bestCostVariation;
+}
+
+template <class Tabu>
+double TSPSolver::eliteRescan ( const TSP& tsp , const TSPSolution& currSol , int currIter , double aspiration , TSPMove& move , const Tabu& tabu )
+{
+    for ( uint k = 0 ; k < currSol.sequence.size() - 1 ; ++k ) position[currSol.sequence[k]] = k;
+    eliteAge = 0;
+    elite.clear();
+    elite.reserve(eliteSize);
+    auto worse = [](const EliteMove& x, const EliteMove& y) { return x.delta < y.delta; }; // max-heap on delta
+
+    double bestCostVariation = tsp.infinite;
+    for ( uint a = 1 ; a < currSol.sequence.size() - 2 ; a++ ) {
+        int h = currSol.sequence[a-1];
+        int i = currSol.sequence[a];
+        
+        for ( uint b = a + 1 ; b < currSol.sequence.size() - 1 ; b++ ) {
+            int j = currSol.sequence[b];
+            int l = currSol.sequence[b+1];
+            double neighCostVariation = - tsp.cost[h][i] - tsp.cost[j][l] + tsp.cost[h][j] + tsp.cost[i][l] ;
+
+            // keep the eliteSize best moves, tabu or not (their status changes with the iterations)
+            if ( (int)elite.size() < eliteSize ) {
+                elite.push_back({neighCostVariation, i, j});
+                std::push_heap(elite.begin(), elite.end(), worse);
+            }
+            else if ( neighCostVariation < elite.front().delta ) {
+                std::pop_heap(elite.begin(), elite.end(), worse);
+                elite.back() = {neighCostVariation, i, j};
+                std::push_heap(elite.begin(), elite.end(), worse);
+            }
+
+            if ( tabu.isTabu(h,i,j,l,currIter,tabuLength) && !(neighCostVariation < aspiration-0.01) ) continue;
+            if ( neighCostVariation < bestCostVariation ) {
+                bestCostVariation = neighCostVariation;
+                move.from = a;
+                move.to = b;
+            }
+        }
+    }
+    eliteWorst = elite.empty() ? tsp.infinite : elite.front().delta;
+    return bestCostVariation;
+}
+
+template <class Tabu, bool Penalized>
+double TSPSolver::scanNeighbors ( const TSP& tsp , const TSPSolution& currSol , int currIter , double aspiration , TSPMove& move , const Tabu& tabu )
     /* Determine the NON-TABU *move* yielding the best 2-opt neigbor solution 
     * Aspiration criteria: 'neighCostVariation' better than 'aspiration' (notice that 'aspiration'
     * has been set such that if 'neighCostVariation' is better than 'aspiration' than we have a
     * new incumbent solution)
+    * Penalized: moves are compared on cost variation + frequency penalty (the real variation is returned)
     */
 {
     double bestCostVariation = tsp.infinite;
+    double bestPenalizedVariation = tsp.infinite;
+    int n = tsp.n;
 
     // intial and final position are fixed (initial/final node remains 0)
     for ( uint a = 1 ; a < currSol.sequence.size() - 2 ; a++ ) {
@@ -119,10 +502,19 @@ double TSPSolver::findBestNeighbor ( const TSP& tsp , const TSPSolution& currSol
             
             double neighCostVariation = - tsp.cost[h][i] - tsp.cost[j][l] + tsp.cost[h][j] + tsp.cost[i][l] ;
             
-            if ( isTabu(i,j,currIter) && !(neighCostVariation < aspiration-0.01) ) {
+            if ( tabu.isTabu(h,i,j,l,currIter,tabuLength) && !(neighCostVariation < aspiration-0.01) ) {
                 continue;             // check if tabu and not aspiration criteria
             }
-            if ( neighCostVariation < bestCostVariation ) {
+            if ( Penalized ) {
+                double penalized = neighCostVariation + penaltyFactor * ( frequency[h*n+j] + frequency[i*n+l] );
+                if ( penalized < bestPenalizedVariation ) {
+                    bestPenalizedVariation = penalized;
+                    bestCostVariation = neighCostVariation;
+                    move.from = a;
+                    move.to = b;
+                }
+            }
+            else if ( neighCostVariation < bestCostVariation ) {
                 bestCostVariation = neighCostVariation;
                 move.from = a;
                 move.to = b;
@@ -131,3 +523,242 @@ double TSPSolver::findBestNeighbor ( const TSP& tsp , const TSPSolution& currSol
     }
     return bestCostVariation;
 }
+
+bool TSPSolver::initGreedy ( const TSP& tsp , TSPSolution& sol , int k )
+{
+    int n = tsp.n;
+    if ( n < 3 ) return initHeu1(tsp, sol);
+
+    // candidate edges (i,j) from the k nearest neighbours of every node
+    CandidateList cand;
+    cand.buildNearest(tsp, k);
+    std::vector<TSPMove> edges;
+    edges.reserve(n*cand.k);
+    bool smallIntegers = true; // lattice instances: Manhattan distances are small integers
+    double maxCost = 0;
+    for ( int i = 0 ; i < n ; ++i ) {
+        for ( int q = 0 ; q < cand.k ; ++q ) {
+            int j = cand.neighbors(i)[q];
+            edges.push_back({i, j}); // (j,i) may come again from the list of j: rejected as closing a cycle
+            double c = tsp.cost[i][j];
+            if ( c < 0 || c != (int)c || c > (1 << 20) ) smallIntegers = false;
+            maxCost = std::max(maxCost, c);
+        }
+    }
+
+    // sort by cost: counting sort on integer costs, comparison sort otherwise
+    if ( smallIntegers ) {
+        std::vector<int> bucket((int)maxCost + 2, 0);
+        for ( const TSPMove& e : edges ) bucket[(int)tsp.cost[e.from][e.to] + 1]++;
+        for ( uint c = 1 ; c < bucket.size() ; ++c ) bucket[c] += bucket[c-1];
+        std::vector<TSPMove> sorted(edges.size());
+        for ( const TSPMove& e : edges ) sorted[bucket[(int)tsp.cost[e.from][e.to]]++] = e;
+        edges.swap(sorted);
+    }
+    else {
+        std::stable_sort(edges.begin(), edges.end(), [&](const TSPMove& a, const TSPMove& b){
+            return tsp.cost[a.from][a.to] < tsp.cost[b.from][b.to]; });
+    }
+
+    // take an edge if both ends have degree < 2 and it closes no cycle (union-find on the fragments)
+    std::vector<int> adj(2*n, -1);
+    std::vector<int> parent(n);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&](int v) {
+        while ( parent[v] != v ) { parent[v] = parent[parent[v]]; v = parent[v]; }
+        return v;
+    };
+    auto degree = [&](int v) { return (adj[2*v] >= 0) + (adj[2*v+1] >= 0); };
+    auto link = [&](int u, int v) {
+        adj[2*u + (adj[2*u] >= 0)] = v;
+        adj[2*v + (adj[2*v] >= 0)] = u;
+    };
+
+    int taken = 0;
+    for ( const TSPMove& e : edges ) {
+        int u = e.from, v = e.to;
+        if ( degree(u) == 2 || degree(v) == 2 ) continue;
+        int ru = find(u), rv = find(v);
+        if ( ru == rv ) continue;
+        parent[ru] = rv;
+        link(u, v);
+        if ( ++taken == n - 1 ) break;
+    }
+
+    // join the fragments (paths) into a tour: from the end of a fragment go to the nearest free fragment end
+    std::vector<int> ends;
+    for ( int v = 0 ; v < n ; ++v ) {
+        if ( degree(v) < 2 ) ends.push_back(v);
+    }
+    std::vector<char> done(n, 0);
+    auto walk = [&](int s) { // mark the fragment starting at end s, return its other end
+        int prev = -1, v = s;
+        while ( true ) {
+            done[v] = 1;
+            int next = ( adj[2*v] >= 0 && adj[2*v] != prev ) ? adj[2*v] : adj[2*v+1];
+            if ( next < 0 || next == prev ) return v;
+            prev = v;
+            v = next;
+        }
+    };
+
+    int first = ends[0];
+    int last = walk(first);
+    while ( true ) {
+        int best = -1;
+        for ( uint q = 0 ; q < ends.size() ; ) {
+            if ( done[ends[q]] ) { ends[q] = ends.back(); ends.pop_back(); continue; } // lazy removal
+            if ( best < 0 || tsp.cost[last][ends[q]] < tsp.cost[last][best] ) best = ends[q];
+            ++q;
+        }
+        if ( best < 0 ) break;
+        int end = walk(best);
+        link(last, best);
+        last = end;
+    }
+    link(last, first);
+
+    sol.fromAdjacency(adj);
+
+    #if PRINT_ALL_TPSOLVER
+        std::cout << "### "; sol.print(); std::cout << " ###" << std::endl;
+    #endif
+
+    return true;
+}
+
+bool TSPSolver::initInsertion ( const TSP& tsp , TSPSolution& sol , Insertion rule , int k )
+{
+    int n = tsp.n;
+    if ( n < 3 ) return initHeu1(tsp, sol);
+    const std::vector< std::vector<double> >& c = tsp.cost;
+    CandidateList cand;
+    if ( k > 0 ) cand.buildNearest(tsp, k);
+
+    // partial tour as a doubly linked list (edge a -> next[a]), starting from 0 and its nearest (farthest) node
+    std::vector<int> next(n, -1), prev(n, -1);
+    int second = 1;
+    for ( int j = 2 ; j < n ; ++j ) {
+        if ( rule == FARTHEST_INSERTION ? c[0][j] > c[0][second] : c[0][j] < c[0][second] ) second = j;
+    }
+    next[0] = prev[0] = second;
+    next[second] = prev[second] = 0;
+
+    std::vector<int> out; // nodes not in the tour yet
+    for ( int v = 1 ; v < n ; ++v ) {
+        if ( v != second ) out.push_back(v);
+    }
+
+    // best insertion edge (edge[w], next[edge[w]]) of every node outside and its cost; the nodes whose best edge
+    // starts at a are chained in a list (first[a], after[w], before[w]), so a split edge finds them in O(their number)
+    // and marks them stale (edge -1): their cost is then a lower bound, the tour is scanned again only when needed
+    auto insertionCost = [&](int a, int v) { return c[a][v] + c[v][next[a]] - c[a][next[a]]; };
+    std::vector<int> edge(n, -1), first(n, -1), after(n, -1), before(n, -1);
+    std::vector<double> gain(n);
+    auto attach = [&](int w, int a) {
+        edge[w] = a;
+        before[w] = -1;
+        after[w] = first[a];
+        if ( first[a] >= 0 ) before[first[a]] = w;
+        first[a] = w;
+    };
+    auto detach = [&](int w) {
+        if ( edge[w] < 0 ) return;
+        if ( before[w] >= 0 ) after[before[w]] = after[w];
+        else first[edge[w]] = after[w];
+        if ( after[w] >= 0 ) before[after[w]] = before[w];
+    };
+    auto offer = [&](int w, int a) { // edge (a,next[a]) for w: kept if cheaper (as cheap for a stale node)
+        double d = c[a][w] + c[next[a]][w] - c[a][next[a]]; // symmetric costs (as the 2-opt moves): rows a and next[a]
+        if ( d < gain[w] || ( edge[w] < 0 && d <= gain[w] ) ) { detach(w); gain[w] = d; attach(w, a); }
+    };
+    auto recompute = [&](int w) { // tour edges at the candidate neighbours in the tour, all the tour if none
+        gain[w] = HUGE_VAL;
+        int best = -1;
+        auto consider = [&](int a) {
+            double d = insertionCost(a, w);
+            if ( d < gain[w] ) { gain[w] = d; best = a; }
+        };
+        for ( int q = 0 ; q < cand.k ; ++q ) {
+            int u = cand.neighbors(w)[q];
+            if ( next[u] >= 0 ) { consider(prev[u]); consider(u); }
+        }
+        if ( best < 0 ) {
+            consider(0);
+            for ( int a = next[0] ; a != 0 ; a = next[a] ) consider(a);
+        }
+        attach(w, best);
+    };
+
+    // heap keys: cheapest -> cost of the best insertion edge (a lower bound while stale)
+    //            nearest  -> distance from the tour;  farthest -> minus the distance from the tour
+    IndexedHeap heap(n);
+    for ( int v : out ) {
+        gain[v] = insertionCost(0, v);
+        attach(v, 0);
+        offer(v, second);
+        double key = gain[v];
+        if ( rule != CHEAPEST_INSERTION ) {
+            key = std::min(c[0][v], c[second][v]);
+            if ( rule == FARTHEST_INSERTION ) key = -key;
+        }
+        heap.push(v, key);
+    }
+
+    while ( !heap.empty() ) {
+        int v = heap.top();
+        if ( edge[v] < 0 ) { // stale: its best edge again; cheapest: back in the heap if it now costs more
+            recompute(v);
+            if ( rule == CHEAPEST_INSERTION && gain[v] != heap.key(v) ) { heap.update(v, gain[v]); continue; }
+        }
+        heap.pop();
+        int a = edge[v];
+        detach(v);
+        int b = next[a];
+        next[a] = v;  prev[v] = a;
+        next[v] = b;  prev[b] = v;
+
+        // nodes whose best edge was (a,b): stale
+        for ( int w = first[a] ; w >= 0 ; w = after[w] ) edge[w] = -1;
+        first[a] = -1;
+
+        // the nodes outside compare their best edge to the two new edges: all of them, or the candidate
+        // neighbours of v with candidate lists (a node far from v may then keep an edge a little worse than the best)
+        auto update = [&](int w) {
+            offer(w, a); // (a,v)
+            offer(w, v); // (v,b)
+            if ( rule == CHEAPEST_INSERTION && gain[w] != heap.key(w) ) heap.update(w, gain[w]);
+        };
+        if ( cand.k > 0 ) {
+            for ( int q = 0 ; q < cand.k ; ++q ) {
+                int w = cand.neighbors(v)[q];
+                if ( heap.contains(w) ) update(w);
+            }
+        }
+
+        // nearest, farthest: distance from the tour of every node outside (one comparison each)
+        if ( cand.k == 0 || rule != CHEAPEST_INSERTION ) {
+            for ( uint q = 0 ; q < out.size() ; ) {
+                int w = out[q];
+                if ( w == v ) { out[q] = out.back(); out.pop_back(); continue; }
+                ++q;
+                if ( cand.k == 0 ) update(w);
+                if ( rule != CHEAPEST_INSERTION ) {
+                    double dist = ( rule == FARTHEST_INSERTION ) ? -heap.key(w) : heap.key(w);
+                    if ( c[v][w] < dist ) heap.update(w, ( rule == FARTHEST_INSERTION ) ? -c[v][w] : c[v][w]);
+                }
+            }
+        }
+    }
+
+    sol.sequence[0] = 0;
+    int pos = 1;
+    for ( int v = next[0] ; v != 0 ; v = next[v] ) sol.sequence[pos++] = v;
+    sol.sequence[n] = 0;
+
+    #if PRINT_ALL_TPSOLVER
+        std::cout << "### "; sol.print(); std::cout << " ###" << std::endl;
+    #endif
+
+    return true;
+}
@@ -7,7 +7,16 @@
 #pragma once
 
 #include <unistd.h>
+#include <functional>
 #include "TSPSolution.h"
+#include "SpatialGrid.h"
+#include "CandidateList.h"
+#include "IndexedHeap.h"
+#include "ReactiveTabu.h"
+#include "TabuPolicy.h"
+#include "Budget.h"
+
+#define GRID_NN_MIN_NODES 500 // coordinate instances from this size use the grid nearest neighbour
 
 /**
  * Class representing substring reversal move
@@ -24,7 +33,24 @@ class TSPSolver
 {
 public:
 
-    TSPSolver ( ) { }
+    TSPSolver ( ) : reactive(false) , tabuRule(NODE_TABU) , stagnation(0) , diversifyLength(10) , penaltyWeight(0.5) ,
+                    exploration(FULL_SCAN) , eliteSize(50) , lowerBound(-HUGE_VAL) , checkpointEvery(60) { }
+
+    /// search options (set before solve)
+    enum TabuRule { NODE_TABU , EDGE_TABU };
+    bool     reactive; // reactive tabu search: tabulength is only the initial value, then adapted to the cycles detected
+    TabuRule tabuRule; // what the tabu list forbids (see TabuPolicy.h)
+    int      stagnation;      // long-term memory: iterations without a new incumbent that start a diversification phase (0: never)
+    int      diversifyLength; // iterations of a diversification phase
+    double   penaltyWeight;   // diversification: a move pays penaltyWeight * (average edge cost) * (frequency of its new edges) / (iteration / n)
+    enum Exploration { FULL_SCAN , ELITE_LIST , DELTA_TABLE };
+    Exploration exploration;  // how the 2-opt neighbourhood is explored at each iteration
+    int      eliteSize;       // ELITE_LIST: moves kept by a full scan and re-scored in the next iterations
+    double   lowerBound;      // known lower bound (e.g. OneTree::lowerBound): the search stops when the incumbent meets it
+    std::string checkpointFile;  // search state saved there every checkpointEvery seconds, and resumed from it by solve ("": never)
+    double      checkpointEvery; // (the file is removed when the search ends, kept when it is cancelled)
+    SearchBudget budget;         // time limits and cancellation flag: solve stops and returns the best tour found so far
+    std::function<void(const TSPSolution& sol, double value, int iter)> onImprovement; // called with every new incumbent
 
     double evaluate ( const TSPSolution& sol , const TSP& tsp ) const {
         double total = 0.0;
@@ -36,34 +62,9 @@ public:
         return total;
     }
 
-    // better seed for srand() using a mix function
-    unsigned long superSeed()
-    {	
-        unsigned long a = clock();
-        unsigned long b = time(NULL);
-        unsigned long c = getpid();
-        a=a-b;  a=a-c;  a=a^(c >> 13);
-        b=b-c;  b=b-a;  b=b^(a << 8);
-        c=c-a;  c=c-b;  c=c^(b >> 13);
-        a=a-b;  a=a-c;  a=a^(c >> 12);
-        b=b-c;  b=b-a;  b=b^(a << 16);
-        c=c-a;  c=c-b;  c=c^(b >> 5);
-        a=a-b;  a=a-c;  a=a^(c >> 3);
-        b=b-c;  b=b-a;  b=b^(a << 10);
-        c=c-a;  c=c-b;  c=c^(b >> 15);
-        return c;
-    }
-
     bool initRnd ( TSPSolution& sol ) {
-        srand(superSeed());
-        for ( uint i = 1 ; i < sol.sequence.size() ; ++i ) {
-            // intial and final position are fixed (initial/final node remains 0)
-            int idx1 = rand() % (sol.sequence.size()-2) + 1;
-            int idx2 = rand() % (sol.sequence.size()-2) + 1;
-            int tmp = sol.sequence[idx1];
-            sol.sequence[idx1] = sol.sequence[idx2];
-            sol.sequence[idx2] = tmp;
-        }
+        Rng rng(Rng::INITIAL);
+        rng.shuffle(sol.sequence.begin() + 1, sol.sequence.end() - 1); // intial and final position are fixed (node 0)
 
         #if PRINT_ALL_TPSOLVER
             std::cout << "### "; sol.print(); std::cout << " ###" << std::endl;
@@ -71,51 +72,33 @@ public:
 
         return true;
     }
-    // heuristic initial solution -> choose min from each row
+    // heuristic initial solution -> nearest neighbour from node 0: choose min from each row among the unvisited nodes
+    // O(n^2) linear min scans on a cost matrix, grid search on coordinate instances (ties: lowest index)
     bool initHeu1(const TSP& tsp, TSPSolution& sol) 
     {
-        // clean sequence
-        for (uint i = 1 ; i < sol.sequence.size()-1 ; ++i ) sol.sequence[i] = -1;
+        if (!tsp.coord.empty() && tsp.n >= GRID_NN_MIN_NODES) return initHeu1Grid(tsp, sol);
 
-        std::vector<int> visited;
-        int i = 0;
-        visited.push_back(0);
+        std::vector<char> visited(tsp.n, 0);
+        visited[0] = 1;
         int prev = 0;
 
-        while (i < tsp.n - 1) 
+        for (int i = 1; i < tsp.n; i++) 
         {
-            // sort as indices
-            std::vector<int> V(tsp.n);
-            std::iota(V.begin(),V.end(),0); //Initializing
-            sort(V.begin(),V.end(), [&](int a,int j){return tsp.cost[prev][a]<tsp.cost[prev][j];} );
-        
+            const std::vector<double>& row = tsp.cost[prev];
+            int next = -1;
+            for (int j = 1; j < tsp.n; j++) {
+                if (!visited[j] && (next < 0 || row[j] < row[next])) next = j;
+            }
+
             #if PRINT_ALL_TPSOLVER
-                std::cout << "prev: " << prev << " " << std::endl;
-                for ( uint i = 0 ; i < V.size() ; ++i ) std::cout << V[i] << " ";
-                std::cout << " ###" << std::endl;
+                std::cout << "prev: " << prev << ", i = " << i << ", index: " << next << std::endl;
             #endif
 
-            for (uint b = 1; b < V.size(); b++){ // exclude actual min because it is 
-                #if PRINT_ALL_TPSOLVER
-                    std::cout << "i = " << i << ", index: " << V[b] << std::endl;
-                #endif
-
-                int temp = V[b];
-                if (!std::count(visited.begin(), visited.end(), temp))
-                {
-                    sol.sequence[i+1] = temp;
-                    visited.push_back(temp);
-                    prev = temp;
-                    i++;
-
-                    #if PRINT_ALL_TPSOLVER
-                        std::cout << "### "; sol.print(); std::cout << " ###" << std::endl;
-                    #endif
-
-                    break;
-                }
-            }
+            sol.sequence[i] = next;
+            visited[next] = 1;
+            prev = next;
         }
+        sol.sequence[0] = sol.sequence[tsp.n] = 0;
 
         #if PRINT_ALL_TPSOLVER
             std::cout << "### "; sol.print(); std::cout << " ###" << std::endl;
@@ -124,8 +107,45 @@ public:
         return true;
     }
 
+    // nearest neighbour on a coordinate instance (same tour as initHeu1 on the cost matrix)
+    bool initHeu1Grid(const TSP& tsp, TSPSolution& sol)
+    {
+        std::vector<int> nodes(tsp.n - 1);
+        std::iota(nodes.begin(), nodes.end(), 1);
+        SpatialGrid grid(tsp);
+        grid.build(nodes);
+
+        int prev = 0;
+        for (int i = 1; i < tsp.n; i++) {
+            int next = grid.nearest(tsp.coord[prev][0], tsp.coord[prev][1]);
+            grid.remove(next);
+            sol.sequence[i] = next;
+            prev = next;
+        }
+        sol.sequence[0] = sol.sequence[tsp.n] = 0;
+        return true;
+    }
+
+    // space filling curve initial solution -> holes in the order of a Hilbert curve (nearest neighbour if no positions)
+    bool initHilbert(const TSP& tsp, TSPSolution& sol)
+    {
+        if (tsp.coord.empty()) return initHeu1(tsp, sol);
+        std::vector<int> order = tsp.hilbertOrder();
+        std::copy(order.begin(), order.end(), sol.sequence.begin());
+        sol.sequence[tsp.n] = 0;
+        return true;
+    }
+
+    // greedy edge initial solution -> shortest candidate edges first (k nearest per node), then fragments joined by nearest endpoint
+    bool initGreedy(const TSP& tsp, TSPSolution& sol, int k = 10);
 
+    // insertion initial solutions -> the tour grows from node 0 by inserting, at its cheapest position, the node
+    // with the cheapest insertion / the farthest from the tour / the nearest to the tour (indexed heap of the nodes);
+    // k > 0: only the k nearest neighbours of an inserted node are updated (approximate, for large boards)
+    enum Insertion { CHEAPEST_INSERTION , FARTHEST_INSERTION , NEAREST_INSERTION };
+    bool initInsertion(const TSP& tsp, TSPSolution& sol, Insertion rule, int k = 0);
 
+    /// @return false on error (a checkpoint error is thrown as CheckpointError)
     bool solve(const TSP& tsp, const TSPSolution& initSol, int tabulength, int maxIter, TSPSolution& bestSol); 
 
 protected:
@@ -133,24 +153,92 @@ protected:
     
     TSPSolution& swap(TSPSolution& tspSol, const TSPMove& move);
     
-    /// Tabu search (tabu list stores, for each node, when (last iteration) a move involving that node have been chosen)
-    ///  a neighbor is tabu if the generating move involves two nodes that have been chosen in the last 'tabulength' moves
-    ///  that is, currentIteration - LastTimeInvolved <= tabuLength
-    int               tabuLength;
-    std::vector<int>  tabuList;
-
-    void initTabuList(int n) {
-        for (int i = 0 ; i < n ; ++i ) 
-            tabuList.push_back(-tabuLength-1);
-            // at iterarion 0, no neighbor is tabu --> iteration(= 0) - tabulistInit > tabulength --> tabulistInit < tabuLength + 0
+    /// scan of the 2-opt neighbourhood with a given tabu rule (the rule is known at compile time, no virtual call per move)
+    template <class Tabu, bool Penalized>
+    double scanNeighbors(const TSP& tsp, const TSPSolution& currSol, int currIter, double aspiration, TSPMove& move, const Tabu& tabu);
+
+    /// elite candidate list (Glover): a full scan keeps the eliteSize best moves, the next iterations only re-score those
+    /// (a move is stored by its two nodes i,j and re-read at their current positions); a new full scan is done
+    /// when the best re-scored move is worse than the worst kept one, when none is allowed, or after eliteSize/2 iterations
+    struct EliteMove { double delta; int i; int j; };
+    std::vector<EliteMove> elite;     // heap on delta (worst on top) during the full scan
+    double                 eliteWorst;
+    int                    eliteAge;  // iterations since the last full scan (-1: list invalid)
+    std::vector<int>       position;  // position of each node in the current solution (ELITE_LIST)
+
+    template <class Tabu>
+    double eliteNeighbors(const TSP& tsp, const TSPSolution& currSol, int currIter, double aspiration, TSPMove& move, const Tabu& tabu);
+    template <class Tabu>
+    double eliteRescan(const TSP& tsp, const TSPSolution& currSol, int currIter, double aspiration, TSPMove& move, const Tabu& tabu);
+
+    void updatePositions(const TSPSolution& sol, const TSPMove& move) { // after the reversal of [from,to]
+        for ( int k = move.from ; k <= move.to ; ++k ) position[sol.sequence[k]] = k;
     }
 
-    void updateTabuList(int nodeFrom, int nodeTo ,int iter) {
-        tabuList[nodeFrom] = iter;
-        tabuList[nodeTo]   = iter;
+    /// delta table: the variation of every 2-opt move (a,b), 1 <= a < b <= n-1, in a flat triangular array (row a from
+    /// rowStart[a]), with the first minimum of each row. After the reversal of [from,to] the moves inside the segment are
+    /// only re-indexed, (a,b) takes the value of (from+to-b,from+to-a), the moves outside do not change, and only the
+    /// moves with one end in the segment are computed again
+    std::vector<double> delta;
+    std::vector<size_t> rowStart;
+    std::vector<double> rowMin;
+    std::vector<int>    rowArg;
+    bool                deltaValid;
+
+    double moveDelta ( const TSP& tsp , const TSPSolution& sol , int a , int b ) const {
+        int h = sol.sequence[a-1], i = sol.sequence[a], j = sol.sequence[b], l = sol.sequence[b+1];
+        return ( tsp.cost[h][j] + tsp.cost[i][l] ) - ( tsp.cost[h][i] + tsp.cost[j][l] ); // same bits for the reversed move
+    }
+    void buildDeltas ( const TSP& tsp , const TSPSolution& sol );
+    void updateDeltas ( const TSP& tsp , const TSPSolution& sol , const TSPMove& move );
+    void rowMinimum ( int a , int n );
+    template <class Tabu>
+    double tableNeighbors(const TSP& tsp, const TSPSolution& currSol, int currIter, double aspiration, TSPMove& move, const Tabu& tabu);
+
+    /// long-term memory: frequency[u*n+v] = how many moves have added edge u-v (stagnation > 0)
+    std::vector<int>  frequency;
+    double            penaltyFactor; // > 0 during a diversification phase
+
+    void updateFrequency(const TSPSolution& sol, const TSPMove& move, int n) {
+        int h = sol.sequence[move.from-1], i = sol.sequence[move.from], j = sol.sequence[move.to], l = sol.sequence[move.to+1];
+        frequency[h*n+j]++;  frequency[j*n+h]++;
+        frequency[i*n+l]++;  frequency[l*n+i]++;
+    }
+    
+    /// Tabu search: the tabu list of the chosen rule (nodeTabu or edgeTabu) is updated with every move,
+    ///  a move is tabu according to that rule and the last 'tabuLength' moves
+    int               tabuLength;
+    NodeTabuList      nodeTabu;
+    EdgeTabuList      edgeTabu;
+    ReactiveTabu      reactiveMemory; // visited tours and adaptive tabuLength (reactive == true)
+
+    /// escape from a chaotic attractor: random moves, returns the new value of currSol
+    double escape(const TSP& tsp, TSPSolution& currSol, double currValue, uint64_t& hash, int iter);
+    Rng rng; // random moves of the escapes (stream ESCAPE, seeded again by solve)
+
+    /// checkpoint: the local variables of solve, saved with the search members (tabu lists, reactive memory,
+    /// frequencies, elite list, delta table, random generator), so that a resumed search makes the same moves
+    struct SearchState {
+        int      iter;
+        double   initValue, bestValue, currValue;
+        uint64_t hash;
+        int      lastImprovement, diversifyLeft;
+    };
+    void saveCheckpoint(const TSP& tsp, const TSPSolution& initSol, const TSPSolution& currSol, const TSPSolution& bestSol,
+                        const SearchState& state);
+    /// @return false if there is no checkpoint file (throws if it is not a search of this instance with these options)
+    bool loadCheckpoint(const TSP& tsp, TSPSolution& initSol, TSPSolution& currSol, TSPSolution& bestSol, SearchState& state);
+
+    /// maxLen: the longest tabu length of the search (the reactive tenure grows up to n/2)
+    void initTabuList(int n, int maxLen) {
+        if (tabuRule == EDGE_TABU) edgeTabu.init(n, maxLen);
+        else nodeTabu.init(n, maxLen);
     }
 
-    bool isTabu(int nodeFrom, int nodeTo, int iter) {
-        return ( (iter - tabuList[nodeFrom] <= tabuLength) && (iter - tabuList[nodeTo] <= tabuLength) );
+    /// move [from,to] on sol (before the reversal) chosen at iteration iter
+    void updateTabuList(const TSPSolution& sol, const TSPMove& move, int iter) {
+        int h = sol.sequence[move.from-1], i = sol.sequence[move.from], j = sol.sequence[move.to], l = sol.sequence[move.to+1];
+        if (tabuRule == EDGE_TABU) edgeTabu.update(h, i, j, l, iter);
+        else nodeTabu.update(h, i, j, l, iter);
     }
 };
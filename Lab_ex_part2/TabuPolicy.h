@@ -0,0 +1,136 @@
+/**
+ * @file TabuPolicy.h
+ * @brief tabu list rules for 2-opt moves
+ *
+ */
+
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include "Checkpoint.h"
+
+/**
+ * Tabu rules share the same interface, used by TSPSolver without virtual calls in the neighbourhood scan:
+ *  - init(n, maxLen)               : empty memory for n nodes, tabu lengths up to maxLen
+ *  - update(h, i, j, l, iter)      : the move replacing edges (h,i),(j,l) with (h,j),(i,l) was done at iteration iter
+ *  - isTabu(h, i, j, l, iter, len) : is that move tabu at iteration iter with tabu length len (O(1))
+ *  - save(file) / load(file, n)    : the memory in a checkpoint (load: false if it is not a memory for n nodes)
+ */
+
+/**
+ * Node rule: for each node, when (last iteration) a move involving that node has been chosen.
+ * A move is tabu if both its nodes i and j have been chosen in the last 'len' moves,
+ * that is, currentIteration - LastTimeInvolved <= len
+ */
+class NodeTabuList
+{
+public:
+    void init ( int n , int ) {
+        last.assign(n, std::numeric_limits<int>::min() / 2); // at iteration 0 no node is tabu, for any length
+    }
+
+    void update ( int , int i , int j , int , int iter ) {
+        last[i] = iter;
+        last[j] = iter;
+    }
+
+    bool isTabu ( int , int i , int j , int , int iter , int len ) const {
+        return ( iter - last[i] <= len ) && ( iter - last[j] <= len );
+    }
+
+    void save ( Checkpoint& file ) const { file.put(last); }
+    bool load ( Checkpoint& file , int n ) { return file.get(last) && (int)last.size() == n; }
+
+private:
+    std::vector<int> last;
+};
+
+/**
+ * Edge rule: the edges removed by the last moves can't be added back.
+ * A move is tabu if one of the edges it adds, (h,j) or (i,l), has been removed in the last 'len' moves.
+ * The removed edges are keys (min(u,v), max(u,v)) of a hash table (open addressing, linear probing) with the
+ * iteration of their last removal as value, so every edge removed in the last maxLen moves is remembered whatever
+ * the length; when the table is half full, the entries older than maxLen are dropped (the table grows if needed).
+ * The last removal at each node is kept too: most lookups stop there, without hashing
+ */
+class EdgeTabuList
+{
+public:
+    void init ( int n , int maxLen ) {
+        nodes = n;
+        lost.assign(n, std::numeric_limits<int>::min() / 2);
+        longest = std::max(1, maxLen);
+        size_t size = 64;
+        while ( size < 8 * (size_t)longest ) size *= 2; // 2 edges per move: at most a quarter full after a purge
+        table.assign(size, Entry{0, 0});
+        used = 0;
+    }
+
+    void update ( int h , int i , int j , int l , int iter ) {
+        removed(h, i, iter);
+        removed(j, l, iter);
+    }
+
+    bool isTabu ( int h , int i , int j , int l , int iter , int len ) const {
+        return recent(h, j, iter, len) || recent(i, l, iter, len);
+    }
+
+    void save ( Checkpoint& file ) const { file.put(table); file.put(used); file.put(nodes); file.put(longest); file.put(lost); }
+    bool load ( Checkpoint& file , int n ) {
+        return file.get(table) && file.get(used) && file.get(nodes) && file.get(longest) && file.get(lost)
+               && nodes == n && (int)lost.size() == n
+               && !table.empty() && ( table.size() & (table.size() - 1) ) == 0;
+    }
+
+private:
+    struct Entry { uint64_t key; int when; };
+    std::vector<Entry> table; // size power of 2, key 0 marks the empty slots
+    size_t used;
+    int    nodes;
+    int    longest; // maxLen of init
+    std::vector<int> lost; // iteration of the last edge removed at each node
+
+    static uint64_t edge ( int u , int v ) { return ( (uint64_t)std::min(u, v) << 32 ) + (uint64_t)std::max(u, v) + 1; }
+
+    size_t find ( uint64_t key ) const {
+        size_t mask = table.size() - 1;
+        size_t k = ( ( key * 0x9E3779B97F4A7C15ULL ) >> 32 ) & mask;
+        while ( table[k].key != 0 && table[k].key != key ) k = (k + 1) & mask;
+        return k;
+    }
+
+    void removed ( int u , int v , int iter ) {
+        lost[u] = lost[v] = iter;
+        uint64_t key = edge(u, v);
+        size_t k = find(key);
+        if ( table[k].key == 0 ) {
+            table[k].key = key;
+            if ( ++used * 2 > table.size() ) { table[k].when = iter; purge(iter); return; }
+        }
+        table[k].when = iter;
+    }
+
+    /// keep the edges removed in the last 'longest' moves (twice the table if they fill more than a quarter)
+    void purge ( int iter ) {
+        std::vector<Entry> old;
+        old.swap(table);
+        size_t live = 0;
+        for ( const Entry& e : old ) live += ( e.key != 0 && iter - e.when <= longest );
+        size_t size = old.size();
+        while ( live * 4 > size ) size *= 2;
+        table.assign(size, Entry{0, 0});
+        used = 0;
+        for ( const Entry& e : old ) {
+            if ( e.key != 0 && iter - e.when <= longest ) { table[find(e.key)] = e; ++used; }
+        }
+    }
+
+    bool recent ( int u , int v , int iter , int len ) const {
+        if ( iter - lost[u] > len || iter - lost[v] > len ) return false;
+        const Entry& e = table[find(edge(u, v))];
+        return e.key != 0 && iter - e.when <= len;
+    }
+};
@@ -5,8 +5,23 @@
 
 
 #include <stdexcept>
+#include <string>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <csignal>
 
 #include "TSPSolver.h"
+#include "FixedTSPSolver.h"
+#include "Memetic.h"
+#include "AntColony.h"
+#include "Grasp.h"
+#include "HeldKarp.h"
+#include "BranchBound.h"
+#include "Partition.h"
+#include "Multilevel.h"
+#include "Incremental.h"
 #include "Timer.h"
 
 // error status and messagge buffer
@@ -14,49 +29,274 @@ int status;
 char errmsg[255];
 
 
+// optional "--name value" arguments, removed from argv so that the positional ones keep their index
+std::map<std::string,std::string> parseOptions(int& argc, char const **argv)
+{
+    std::map<std::string,std::string> opts;
+    int k = 0;
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.size() > 2 && arg.compare(0, 2, "--") == 0 && i + 1 < argc) opts[arg.substr(2)] = argv[++i];
+        else argv[k++] = argv[i];
+    }
+    argc = k;
+    return opts;
+}
+
+int intOption(const std::map<std::string,std::string>& opts, const std::string& name, int def)
+{
+    auto it = opts.find(name);
+    return (it == opts.end()) ? def : atoi(it->second.c_str());
+}
+
+double doubleOption(const std::map<std::string,std::string>& opts, const std::string& name, double def)
+{
+    auto it = opts.find(name);
+    return (it == opts.end()) ? def : atof(it->second.c_str());
+}
+
+// SIGINT / SIGTERM during the tabu search: stop and print the best tour found so far
+std::atomic<bool> interrupted(false);
+
+void onSignal(int)
+{
+    interrupted = true;
+}
+
 int main (int argc, char const *argv[])
 {
     try
     {
-        if (argc < 4 ) throw std::runtime_error("usage: ./main filename.dat tabulength maxiter [init] [readPos] [Nrandom] [class] "); 
+        std::map<std::string,std::string> opts = parseOptions(argc, argv);
+        if (argc < 4 ) throw std::runtime_error("usage: ./main filename.dat tabulength maxiter [init] [readPos] [Nrandom] [class] [--mode tabu|memetic|aco|grasp|dp|bb|partition|multilevel] [--cell N] [--coarsest N] [--islands N] [--pop N] [--threads N] [--ants N] [--rcl N] [--candidates nearest|alpha] [--ncand K] [--renumber 1] [--reactive 1] [--tabu node|edge] [--diversify N] [--explore full|elite|delta] [--elite K] [--fixed 0] [--bound K] [--diff file[,file...]] [--load tourfile] [--save tourfile] [--checkpoint file] [--checkpoint-every S] [--time S] [--cpu S] [--progress 1] [--seed N]"); 
         // filename not used if random, readPos: file to read positions, Nrandom: random number of nodes, initHeu: enable initial heuristic solution
+        // tabu edge: forbid adding back recently removed edges (default node: forbid moving two recently moved nodes)
+        // diversify N: after N iterations without improvement, penalise frequently added edges for max(5,N/4) iterations
+        // explore elite: full scans keep the K best moves, re-scored alone in the next iterations
+        // explore delta: table of all the move variations, updated after each move where it changes
+        // bound K: Held-Karp 1-tree lower bound (K subgradient iterations), the tabu search stops when it reaches it
+        // diff file: board revision (remove <id> | move <id> <x> <y> | add <x> <y> per line) applied to the result,
+        //            tour repaired by cheapest insertion and local search around the changes; diff a,b,...: revisions
+        //            applied in sequence (the neighbour lists of the local search are kept from one to the next)
+        // load tourfile: initial solution read from a tour file (text, or binary as written with a .bin name), instead of init
+        // save tourfile: best solution written to a tour file (binary if the name ends with .bin)
+        // checkpoint file: tabu search state saved to file every S seconds (checkpoint-every S, default 60); a run
+        //                 with the same arguments resumes from it, the file is removed when the search ends
+        // time S / cpu S: the tabu search stops after S seconds (wall clock / processor time) with the best tour so far,
+        //                 as on Ctrl-C or SIGTERM; progress 1: every new incumbent printed as it is found
+        // seed N: seed of all the random numbers (instance, initial solution, escapes, threads of aco/grasp/memetic):
+        //         the same seed and threads give the same run (default: from the clock, printed with the result)
+        // reactive 1: tabulength is only the initial tabu length, adapted during the search
+        // mode memetic: maxiter is the number of generations, tabulength is not used
+        // mode aco: maxiter is the number of colony iterations, tabulength is not used
+        // candidates alpha: aco and grasp neighbour lists ranked by 1-tree alpha-nearness (ncand K: list length)
+        // ncand K with init 5, 6 or 7: an insertion only updates the K nearest neighbours of the inserted node
+        // mode partition: positions only (no cost matrix), k-d cells of at most N holes (cell N) solved by tabu search
+        //                with tabulength and maxiter, then merged; init is not used, the FROM solution is the Hilbert
+        //                curve tour (or the --load tour), lengths from the positions
+        // mode multilevel: positions only, paths matched level by level down to N paths (coarsest N), tabu search
+        //                 with tabulength and maxiter on the coarsest level, then refined level by level; as partition
+        //                 for init, the FROM solution and the lengths
+        // mode grasp: maxiter is the number of construction + descent iterations, tabulength is not used
+        std::string mode = opts.count("mode") ? opts["mode"] : "tabu";
+        if (opts.count("seed")) Rng::setRunSeed(std::strtoull(opts["seed"].c_str(), NULL, 10));
 
         int tabuLength = atoi(argv[2]);                                                           
         int maxIter    = atoi(argv[3]);                                                           
         TSP tspInstance; 
-        int init = 0; // 0 for random, 1 for initHeu1
+        int init = 0; // 0 for random, 1 (or 2) for initHeu1, 3 for greedy edge, 4 for Hilbert curve,
+                      // 5 for cheapest insertion, 6 for farthest insertion, 7 for nearest insertion
 
         if (argc > 4) init = atoi(argv[4]); // get required initalization method
             
-        if (argc == 6) tspInstance.readPos(argv[1]); // read positions instead of costs
+        bool costs = (mode != "partition" && mode != "multilevel"); // very large boards: no cost matrix
+        if (argc == 6) tspInstance.readPos(argv[1], costs); // read positions instead of costs
         else if (argc > 6) { // use random cost matrix with N nodes
             int N = atoi(argv[6]);
             int classe = 1;
             if (argc == 8 && N > 3) classe = atoi(argv[7]); // class 2 only possible for 4x4 maps or larger
-            tspInstance.randomCost(N, classe);
+            tspInstance.randomCost(N, classe, costs);
         }
         else tspInstance.readDists(argv[1]);
 
+        if (!costs) { // positions only: the modes that need the cost matrix are not run
+            if (tspInstance.coord.empty()) throw std::runtime_error("mode " + mode + " needs hole positions");
+            if (intOption(opts, "bound", 0) > 0) throw std::runtime_error("--bound needs a cost matrix, not mode " + mode);
+            if (opts.count("diff")) throw std::runtime_error("--diff needs a cost matrix, not mode " + mode);
+        }
+
+        // coordinate instances: number the holes along a Hilbert curve (neighbours in the tour get close cost rows)
+        if (intOption(opts, "renumber", 0) && costs && !tspInstance.coord.empty()) tspInstance.renumber(tspInstance.hilbertOrder());
+
         TSPSolution aSolution(tspInstance);
 
+        if (mode == "dp") { // exact value without CPLEX (small instances), same output as Lab_ex_part1
+            int threads = intOption(opts, "threads", std::max(1u, std::thread::hardware_concurrency()));
+            HeldKarpSolver heldKarp(threads);
+            Log::Timer t;
+            double objval = heldKarp.solve(tspInstance, aSolution);
+            std::cout << "Time: " << t.stopMicro()*1e-6 << " s" << std::endl;
+            std::cout << "Objval: " << objval << std::endl;
+            return 0;
+        }
+
         Log::Timer t; // start timer
 
         TSPSolver tspSolver; // initialization
-        if (init != 0) tspSolver.initHeu1(tspInstance,aSolution);
+        tspSolver.reactive = intOption(opts, "reactive", 0);
+        if (opts.count("tabu")) {
+            if (opts["tabu"] == "edge") tspSolver.tabuRule = TSPSolver::EDGE_TABU;
+            else if (opts["tabu"] != "node") throw std::runtime_error("unknown tabu rule " + opts["tabu"]);
+        }
+        tspSolver.stagnation = intOption(opts, "diversify", 0);
+        if (opts.count("explore")) {
+            if (opts["explore"] == "elite") tspSolver.exploration = TSPSolver::ELITE_LIST;
+            else if (opts["explore"] == "delta") tspSolver.exploration = TSPSolver::DELTA_TABLE;
+            else if (opts["explore"] != "full") throw std::runtime_error("unknown exploration " + opts["explore"]);
+        }
+        tspSolver.eliteSize = intOption(opts, "elite", tspSolver.eliteSize);
+        tspSolver.diversifyLength = std::max(5, tspSolver.stagnation / 4);
+        if (opts.count("checkpoint")) tspSolver.checkpointFile = opts["checkpoint"];
+        tspSolver.checkpointEvery = doubleOption(opts, "checkpoint-every", tspSolver.checkpointEvery);
+        tspSolver.budget.wallSeconds = doubleOption(opts, "time", 0);
+        tspSolver.budget.cpuSeconds = doubleOption(opts, "cpu", 0);
+        if (intOption(opts, "progress", 0)) {
+            tspSolver.onImprovement = [&t](const TSPSolution&, double value, int iter) {
+                std::cout << "incumbent: " << value << " (iteration " << iter << " , " << t.stopMicro()*1e-6 << " s)" << std::endl;
+            };
+        }
+        if (opts.count("load")) { // warm start
+            if (!aSolution.read(tspInstance, opts["load"].c_str())) throw std::runtime_error("not a tour of this instance: " + opts["load"]);
+        }
+        else if (!costs) tspSolver.initHilbert(tspInstance,aSolution); // no cost matrix: the tour the result is compared to
+        else if (init == 3) tspSolver.initGreedy(tspInstance,aSolution);
+        else if (init == 4) tspSolver.initHilbert(tspInstance,aSolution);
+        else if (init == 5) tspSolver.initInsertion(tspInstance,aSolution,TSPSolver::CHEAPEST_INSERTION,intOption(opts, "ncand", 0));
+        else if (init == 6) tspSolver.initInsertion(tspInstance,aSolution,TSPSolver::FARTHEST_INSERTION,intOption(opts, "ncand", 0));
+        else if (init == 7) tspSolver.initInsertion(tspInstance,aSolution,TSPSolver::NEAREST_INSERTION,intOption(opts, "ncand", 0));
+        else if (init != 0) tspSolver.initHeu1(tspInstance,aSolution);
         else tspSolver.initRnd(aSolution);
 
+        // optional lower bound: optimality gap of the result, early stop of the tabu search
+        int boundIterations = intOption(opts, "bound", 0);
+        double lowerBound = -HUGE_VAL;
+        if (boundIterations > 0) {
+            OneTree tree(tspInstance);
+            lowerBound = tree.lowerBound(tspSolver.evaluate(aSolution, tspInstance), boundIterations);
+            tspSolver.lowerBound = lowerBound;
+        }
+
         TSPSolution bestSolution(tspInstance);
-        tspSolver.solve(tspInstance,aSolution, tabuLength, maxIter ,bestSolution); /// solve with TSAC
+        if (mode == "memetic") {
+            int islands = intOption(opts, "islands", std::max(1u, std::thread::hardware_concurrency()));
+            MemeticSolver memetic(intOption(opts, "pop", 20), islands);
+            memetic.solve(tspInstance, aSolution, maxIter, bestSolution);
+        }
+        else if (mode == "aco") {
+            int threads = intOption(opts, "threads", std::max(1u, std::thread::hardware_concurrency()));
+            AntColonySolver aco(intOption(opts, "ants", 0), threads, intOption(opts, "ncand", 15));
+            if (opts.count("candidates") && opts["candidates"] == "alpha") aco.candidateRule = CandidateList::ALPHA;
+            aco.solve(tspInstance, aSolution, maxIter, bestSolution);
+        }
+        else if (mode == "grasp") {
+            int threads = intOption(opts, "threads", std::max(1u, std::thread::hardware_concurrency()));
+            GraspSolver grasp(intOption(opts, "rcl", 3), threads, intOption(opts, "ncand", 50));
+            if (opts.count("candidates") && opts["candidates"] == "alpha") grasp.candidateRule = CandidateList::ALPHA;
+            grasp.solve(tspInstance, aSolution, maxIter, bestSolution);
+        }
+        else if (mode == "partition") { // very large boards: k-d cells, one tabu search per cell, merged tour improved
+            int threads = intOption(opts, "threads", std::max(1u, std::thread::hardware_concurrency()));
+            int cell = intOption(opts, "cell", 100);
+            if (cell < 1) throw std::runtime_error("--cell must be at least 1");
+            PartitionSolver partition(cell, threads);
+            partition.solve(tspInstance, tabuLength, maxIter, bestSolution);
+        }
+        else if (mode == "multilevel") { // large boards: coarsening by matching, tabu search, refinement on every level
+            int threads = intOption(opts, "threads", std::max(1u, std::thread::hardware_concurrency()));
+            MultilevelSolver multilevel(intOption(opts, "coarsest", 50), 8, threads);
+            multilevel.solve(tspInstance, tabuLength, maxIter, bestSolution);
+        }
+        else if (mode == "tabu") {
+            // default options on a small board: same search on the fixed size solver (no heap, no copies per move)
+            bool plain = !tspSolver.reactive && tspSolver.tabuRule == TSPSolver::NODE_TABU && tspSolver.stagnation == 0
+                         && tspSolver.exploration == TSPSolver::FULL_SCAN && tspSolver.checkpointFile.empty()
+                         && !tspSolver.budget.limited() && !tspSolver.onImprovement && intOption(opts, "fixed", 1);
+            if (!plain || !solveFixed(tspInstance, aSolution, tabuLength, maxIter, bestSolution, lowerBound)) {
+                tspSolver.budget.cancel = &interrupted;
+                std::signal(SIGINT, onSignal);
+                std::signal(SIGTERM, onSignal);
+                if (!tspSolver.solve(tspInstance,aSolution, tabuLength, maxIter ,bestSolution)) /// solve with TSAC
+                    throw std::runtime_error("tabu search failed");
+            }
+        }
+        else if (mode == "bb") { // exact value without CPLEX: tabu search incumbent, then branch and bound
+            TSPSolution incumbent(tspInstance);
+            if (!solveFixed(tspInstance, aSolution, tabuLength, maxIter, incumbent)
+                && !tspSolver.solve(tspInstance, aSolution, tabuLength, maxIter, incumbent))
+                throw std::runtime_error("tabu search failed");
+            int threads = intOption(opts, "threads", std::max(1u, std::thread::hardware_concurrency()));
+            BranchBoundSolver bb(threads);
+            double objval = bb.solve(tspInstance, incumbent, bestSolution);
+            std::cout << "Time: " << t.stopMicro()*1e-6 << " s" << std::endl;
+            std::cout << "Objval: " << objval << std::endl;
+            return 0;
+        }
+        else throw std::runtime_error("unknown mode " + mode);
 
         double micros = t.stopMicro(); 
+
+        // result check: both tours valid, lengths recomputed
+        if (!aSolution.isTour(tspInstance) || !bestSolution.isTour(tspInstance)) throw std::runtime_error("invalid tour in the result");
+        auto length = [&](const TSPSolution& sol) { // no cost matrix: Manhattan distances of the positions
+            if (costs) return tspSolver.evaluate(sol, tspInstance);
+            double total = 0.0;
+            for (int k = 0; k < tspInstance.n; k++) {
+                const std::vector<double>& p = tspInstance.coord[sol.sequence[k]];
+                const std::vector<double>& q = tspInstance.coord[sol.sequence[k+1]];
+                total += std::fabs(p[0] - q[0]) + std::fabs(p[1] - q[1]);
+            }
+            return total;
+        };
+        double fromValue = length(aSolution);
+        double toValue   = length(bestSolution);
+        if (opts.count("save")) {
+            const std::string& file = opts["save"];
+            bool binary = file.size() > 4 && file.compare(file.size() - 4, 4, ".bin") == 0;
+            if (!bestSolution.write(tspInstance, file.c_str(), binary)) throw std::runtime_error("cannot write " + file);
+        }
+        TSPSolution revised(bestSolution); // internal numbering, for a board revision
+        aSolution.restoreIds(tspInstance); // print with the original hole numbers
+        bestSolution.restoreIds(tspInstance);
             
         std::cout << "FROM solution: "; 
         aSolution.print();
-        std::cout << "(value : " << tspSolver.evaluate(aSolution,tspInstance) << ")\n";
+        std::cout << "(value : " << fromValue << ")\n";
         std::cout << "TO   solution: "; 
         bestSolution.print();
-        std::cout << "(value : " << tspSolver.evaluate(bestSolution,tspInstance) << ")\n";
+        std::cout << "(value : " << toValue << ")\n";
+        if (boundIterations > 0)
+            std::cout << "(lower bound : " << lowerBound << " , gap : " << 100 * (toValue - lowerBound) / toValue << " %)\n";
         std::cout << "in " << micros*1e-6 << " seconds\n";
+        std::cout << "(seed : " << Rng::runSeed() << ")\n";
+
+        if (opts.count("diff")) { // revised board: update of the instance and of the tour, no new search
+            IncrementalSolver incremental;
+            std::stringstream files(opts["diff"]);
+            std::string file;
+            while (std::getline(files, file, ',')) {
+                BoardDiff diff;
+                if (!diff.read(file.c_str())) throw std::runtime_error("cannot read the board revision " + file);
+                Log::Timer r;
+                double revisedValue = incremental.apply(tspInstance, revised, diff);
+                double revisedMicros = r.stopMicro();
+                TSPSolution printed(revised);
+                printed.restoreIds(tspInstance);
+                std::cout << "REVISED solution: ";
+                printed.print();
+                std::cout << "(value : " << revisedValue << ")\n";
+                std::cout << "in " << revisedMicros*1e-6 << " seconds\n";
+            }
+        }
         
     }
     catch(std::exception& e)